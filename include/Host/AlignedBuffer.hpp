@@ -0,0 +1,49 @@
+#ifndef __ALIGNED_BUFFER__
+#define __ALIGNED_BUFFER__
+
+#include <cstdlib>
+#include <memory>
+#include <new>
+
+// Grow-only, cache line aligned scratch buffer of floats. Host kernels keep
+// these (usually thread_local) for packed panels and workspaces, so that
+// repeated calls do not hit the allocator. Contents are not preserved when
+// the buffer grows.
+class AlignedBuffer {
+  private:
+    struct AlignedFree {
+        void operator()(float *ptr) const { std::free(ptr); }
+    };
+
+    std::unique_ptr<float[], AlignedFree> m_data;
+    size_t m_size = 0;
+
+  public:
+    static constexpr size_t ALIGNMENT = 64;
+
+    float *reserve(size_t count) {
+        if (count > m_size) {
+            size_t bytes = count * sizeof(float);
+            bytes = (bytes + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+            float *ptr =
+                static_cast<float *>(std::aligned_alloc(ALIGNMENT, bytes));
+            if (!ptr) {
+                throw std::bad_alloc();
+            }
+            m_data.reset(ptr);
+            m_size = count;
+        }
+        return m_data.get();
+    }
+
+    // reserve for count elements of another type, e.g. double or int8_t
+    // scratch, with the same alignment
+    template <class T> T *reserve_as(size_t count) {
+        return reinterpret_cast<T *>(
+            reserve((count * sizeof(T) + sizeof(float) - 1) / sizeof(float)));
+    }
+
+    float *data() const { return m_data.get(); }
+};
+
+#endif
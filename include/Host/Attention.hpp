@@ -0,0 +1,41 @@
+#ifndef __ATTENTION__
+#define __ATTENTION__
+
+#include <cstddef>
+
+// Fused scaled dot-product attention on the host:
+//     O = softmax(scale * Q * K^T + mask) * V
+// with the softmax taken over each row. Q is Lq x D, K is Lk x D, V is Lk x Dv
+// and O is Lq x Dv, all row-major with row strides ldq, ldk, ldv and ldo.
+//
+// The Lq x Lk score matrix is never written to memory. Each block of query
+// rows walks the keys in blocks: the scores of one block are computed by the
+// GEMM micro-kernels into an L1/L2 sized scratch tile, folded into a running
+// row maximum and row sum (online softmax) and multiplied with V straight
+// away, rescaling the partial output whenever the row maximum grows. Query
+// blocks are load balanced over the host thread pool.
+//
+// With `causal` set, query i only sees keys j <= i + Lk - Lq (the usual
+// bottom-right alignment, j <= i for square problems). Key blocks that are
+// masked for the whole query block are never visited and masked register
+// tiles on the diagonal are not computed. Query rows that see no key at all
+// get zeros.
+//
+// Throws std::invalid_argument when a dimension is negative or a leading
+// dimension is smaller than its row.
+void host_attention(int Lq, int Lk, int D, int Dv, const float *Q, int ldq,
+                    const float *K, int ldk, const float *V, int ldv,
+                    float *O, int ldo, float scale, bool causal);
+
+// Independent attention problems of one shape, e.g. the heads of a layer,
+// with member i using Q + i * strideQ and so on (strides in elements). All
+// query blocks of all members run as one parallel region. Throws as above,
+// for a negative batch or for overlapping outputs.
+void host_attention_batched(int Lq, int Lk, int D, int Dv, const float *Q,
+                            int ldq, ptrdiff_t strideQ, const float *K,
+                            int ldk, ptrdiff_t strideK, const float *V,
+                            int ldv, ptrdiff_t strideV, float *O, int ldo,
+                            ptrdiff_t strideO, float scale, bool causal,
+                            int batch);
+
+#endif
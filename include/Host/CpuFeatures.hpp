@@ -0,0 +1,21 @@
+#ifndef __CPU_FEATURES__
+#define __CPU_FEATURES__
+
+// Instruction set extensions of the host CPU that the host kernels dispatch
+// on. Detected once via CPUID (and XGETBV, so that extensions whose register
+// state the OS does not save are reported as missing).
+struct CpuFeatures {
+    bool sse42 = false;
+    bool avx = false;
+    bool avx2 = false;
+    bool fma = false;
+    bool f16c = false; // fp16 <-> fp32 conversions
+    bool avx512f = false;
+    bool avx512bf16 = false; // fp32 -> bf16 conversions
+    bool avx512vnni = false; // int8 dot products
+    bool neon = false;
+};
+
+const CpuFeatures &cpu_features();
+
+#endif
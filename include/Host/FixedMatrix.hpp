@@ -0,0 +1,83 @@
+#ifndef __FIXED_MATRIX__
+#define __FIXED_MATRIX__
+
+#include <cstddef>
+#include <utility>
+
+// Row-major R x C matrix whose shape is known at compile time. Products of
+// these are expanded into straight-line code by index_sequence folds, so the
+// operands live in registers and there is no loop or bounds bookkeeping left
+// at runtime. Sums are accumulated in k order, like the other kernels.
+template <int R, int C> struct Matrix {
+    static_assert(R > 0 && C > 0, "Matrix dimensions must be positive");
+
+    float m[R * C];
+
+    static constexpr int rows = R;
+    static constexpr int cols = C;
+
+    constexpr float &operator()(int i, int j) { return m[i * C + j]; }
+    constexpr float operator()(int i, int j) const { return m[i * C + j]; }
+
+    // Element (i, j) is read from src[i * rs + j * cs]
+    static constexpr Matrix load(const float *src, int rs, int cs) {
+        return load(src, rs, cs, std::make_index_sequence<R * C>());
+    }
+
+    static constexpr Matrix load(const float *src, int ld) {
+        return load(src, ld, 1);
+    }
+
+    constexpr void store(float *dst, int ld) const {
+        store(dst, ld, std::make_index_sequence<R * C>());
+    }
+
+  private:
+    template <size_t... I>
+    static constexpr Matrix load(const float *src, int rs, int cs,
+                                 std::index_sequence<I...>) {
+        return {{src[(I / C) * rs + (I % C) * cs]...}};
+    }
+
+    template <size_t... I>
+    constexpr void store(float *dst, int ld, std::index_sequence<I...>) const {
+        ((dst[(I / C) * ld + (I % C)] = m[I]), ...);
+    }
+};
+
+namespace fixed_matrix_detail {
+
+template <int M, int K, int N, size_t... P>
+constexpr float dot(const Matrix<M, K> &a, const Matrix<K, N> &b, int i, int j,
+                    std::index_sequence<P...>) {
+    return (0.0f + ... + (a.m[i * K + P] * b.m[P * N + j]));
+}
+
+template <int M, int K, int N, size_t... I>
+constexpr Matrix<M, N> multiply(const Matrix<M, K> &a, const Matrix<K, N> &b,
+                                std::index_sequence<I...>) {
+    return {{dot(a, b, I / N, I % N, std::make_index_sequence<K>())...}};
+}
+
+} // namespace fixed_matrix_detail
+
+template <int M, int K, int N>
+constexpr Matrix<M, N> operator*(const Matrix<M, K> &a,
+                                 const Matrix<K, N> &b) {
+    return fixed_matrix_detail::multiply(a, b,
+                                         std::make_index_sequence<M * N>());
+}
+
+// Largest M, N and K routed to the fixed-size kernels by the host GEMM
+constexpr int FIXED_MATRIX_MAX_DIM = 4;
+
+// C = alpha * A * B + beta * C through the Matrix<M, K> * Matrix<K, N>
+// specialization for the given runtime shape. Element (i, k) of A is read
+// from A[i * rsa + k * csa] and likewise for B, so transposed operands work
+// too. C is not read when beta is zero. Returns false, without touching C,
+// when any dimension is outside 1 .. FIXED_MATRIX_MAX_DIM.
+bool fixed_matrix_multiply(int M, int N, int K, float alpha, const float *A,
+                           int rsa, int csa, const float *B, int rsb, int csb,
+                           float beta, float *C, int ldc);
+
+#endif
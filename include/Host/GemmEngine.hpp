@@ -0,0 +1,66 @@
+#ifndef __GEMM_ENGINE__
+#define __GEMM_ENGINE__
+
+#include <Host/GemmKernels.hpp>
+#include <Host/HostGemm.hpp>
+#include <Host/TypedGemm.hpp>
+#include <complex>
+
+// Interface between the blocked GEMM engine of HostGemm.cpp and the complex
+// products of TypedGemm.cpp. The engine owns blocking, packing, the
+// schedules (Tiled, SplitK, StreamK), degenerate shape routing and tiling
+// for every element type. Real types run its packed loop nest on their own
+// micro-kernels; complex types hand every block to complex_gemm_block,
+// which splits it into real planes and runs the kernels of the component
+// type.
+
+// Strided view of a row-major operand, element (i, j) at data[i * rs +
+// j * cs]. conj marks a conjugated complex operand.
+template <class T> struct GemmStrided {
+    const T *data;
+    int rs;
+    int cs;
+    bool conj;
+};
+
+// Micro-kernels of the component type and the method of a complex product.
+// blocking is the component kernel's blocking with kc cut so that the two or
+// three planes of a block fit the cache budget of one real block.
+template <class R> struct ComplexGemmKernel {
+    const GemmKernelOf<R> *real;
+    ComplexGemmMethod method;
+    GemmBlocking blocking;
+};
+
+// Kernel type the engine runs an element type on
+template <class T> struct GemmKernelFor {
+    typedef GemmKernelOf<T> type;
+};
+
+template <class R> struct GemmKernelFor<std::complex<R>> {
+    typedef ComplexGemmKernel<R> type;
+};
+
+// C = alpha * A * B + beta * C for an M x K operand A and a K x N operand B
+// on the engine, with the schedule of host_gemm_schedule, followed by the
+// epilogue. Instantiated for double, std::complex<float> and
+// std::complex<double>; arguments are not validated.
+template <class T>
+void gemm_engine(const typename GemmKernelFor<T>::type &kernel, int M, int N,
+                 int K, T alpha, const GemmStrided<T> &A,
+                 const GemmStrided<T> &B, T beta, T *C, int ldc,
+                 const GemmEpilogueOf<T> &epilogue);
+
+// Complex kernel for float or double components (TypedGemm.cpp)
+template <class R>
+ComplexGemmKernel<R> complex_gemm_kernel(ComplexGemmMethod method);
+
+// One M x N block of a complex product, on the calling thread (TypedGemm.cpp)
+template <class R>
+void complex_gemm_block(const ComplexGemmKernel<R> &kernel, int M, int N,
+                        int K, std::complex<R> alpha,
+                        const GemmStrided<std::complex<R>> &A,
+                        const GemmStrided<std::complex<R>> &B,
+                        std::complex<R> beta, std::complex<R> *C, int ldc);
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef __GEMM_KERNELS__
+#define __GEMM_KERNELS__
+
+#include <Host/HalfPrecision.hpp>
+#include <Host/HostGemm.hpp>
+#include <cstddef>
+
+// Register-blocked micro-kernels of the host GEMM engine.
+//
+// A micro-kernel computes one full mr x nr tile of
+//     C = alpha * A * B + beta * C
+// from a packed mr x kc panel of A (mr values per k, contiguous) and a packed
+// kc x nr panel of B (nr values per k, contiguous). Both panels are aligned
+// to the kernel's vector width. C is never read when beta is zero. There is
+// one set of kernels per real element type; complex products run on the
+// kernels of their component type (see TypedGemm.hpp).
+template <class T> struct GemmKernelOf {
+    typedef void (*MicroKernel)(int kc, const T *a, const T *b, T *c, int ldc,
+                                T alpha, T beta);
+
+    const char *name;
+    GemmBlocking blocking;
+    MicroKernel fn;
+};
+
+typedef GemmKernelOf<float>::MicroKernel GemmMicroKernel;
+typedef GemmKernelOf<float> GemmKernel;
+typedef GemmKernelOf<double> DgemmKernel;
+
+// Largest mr * nr over all kernels, for sizing edge tile scratch space
+constexpr int GEMM_MAX_TILE = 14 * 32;
+
+// Packs an mc x kc block of A, element (i, p) at a[i * rs + p * cs], into row
+// panels of MR rows. Within a panel the MR values of one column are
+// contiguous, which is the order the micro-kernel consumes them in. Rows past
+// mc are zero filled.
+void gemm_pack_a(int MR, int mc, int kc, const float *a, ptrdiff_t rs,
+                 ptrdiff_t cs, float *dst);
+
+// Packs a kc x nc panel of B, element (p, j) at b[p * rs + j * cs], into
+// column panels of NR columns, with the NR values of one row contiguous.
+// Columns past nc are zero filled.
+void gemm_pack_b(int NR, int kc, int nc, const float *b, ptrdiff_t rs,
+                 ptrdiff_t cs, float *dst);
+
+void gemm_pack_a(int MR, int mc, int kc, const double *a, ptrdiff_t rs,
+                 ptrdiff_t cs, double *dst);
+void gemm_pack_b(int NR, int kc, int nc, const double *b, ptrdiff_t rs,
+                 ptrdiff_t cs, double *dst);
+
+// As above for operands stored in 16-bit formats. The block is widened to
+// float with the bulk conversions of HalfPrecision.hpp, a contiguous run at a
+// time, and then packed, so the micro-kernels never see the narrow type.
+void gemm_pack_a(int MR, int mc, int kc, const float16 *a, ptrdiff_t rs,
+                 ptrdiff_t cs, float *dst);
+void gemm_pack_a(int MR, int mc, int kc, const bfloat16 *a, ptrdiff_t rs,
+                 ptrdiff_t cs, float *dst);
+void gemm_pack_b(int NR, int kc, int nc, const float16 *b, ptrdiff_t rs,
+                 ptrdiff_t cs, float *dst);
+void gemm_pack_b(int NR, int kc, int nc, const bfloat16 *b, ptrdiff_t rs,
+                 ptrdiff_t cs, float *dst);
+
+// Kernel picked for this CPU. The best kernel supported by CPUID is chosen on
+// first use; HOST_GEMM_KERNEL=<name> in the environment forces a specific
+// (supported) kernel, which is handy for comparing kernels on one machine.
+const GemmKernel &gemm_kernel();
+
+// Double precision kernel, chosen the same way and honouring the same
+// HOST_GEMM_KERNEL names
+const DgemmKernel &dgemm_kernel();
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef __GEMV__
+#define __GEMV__
+
+#include <cstddef>
+
+// Matrix-vector product and rank-1 update. Both only touch every matrix
+// element once, so they are bound by memory bandwidth rather than by the
+// floating point units; blocking and packing as in sgemm would only add
+// passes over memory. The kernels stream the matrix in its storage order
+// with vector accumulators, and large problems are split by rows over the
+// host thread pool. sgemm routes products with N == 1 or M == 1 (GEMV) and
+// K == 1 (rank-1) here on its own.
+
+// y = alpha * op(A) * x + beta * y where op(A) is M x N: A itself for
+// trans = 'N' (M x N, row stride lda) or the transpose of an N x M matrix A
+// for trans = 'T' (or 'C'). x has N elements and y M, spaced incx and incy
+// apart. y is not read when beta is zero. Throws std::invalid_argument on
+// an invalid flag, a negative dimension, a leading dimension smaller than
+// the row or an increment below 1.
+void sgemv(char trans, int M, int N, float alpha, const float *A, int lda,
+           const float *x, int incx, float beta, float *y, int incy);
+
+// A = alpha * x * y^T + A for an M x N matrix A with row stride lda, x of M
+// and y of N elements. Throws as sgemv.
+void sger(int M, int N, float alpha, const float *x, int incx, const float *y,
+          int incy, float *A, int lda);
+
+// Strided forms behind sgemv and sger, also used by the GEMM front ends.
+// Element (i, j) of the matrix is A[i * rs + j * cs]; either stride must be
+// 1 for the vectorized kernels, other layouts take a scalar loop. Both are
+// instantiated for float and double.
+template <class T>
+void gemv_strided(int M, int N, T alpha, const T *A, ptrdiff_t rs,
+                  ptrdiff_t cs, const T *x, ptrdiff_t incx, T beta, T *y,
+                  ptrdiff_t incy);
+
+// C = alpha * x * y^T + beta * C, C not read when beta is zero
+template <class T>
+void rank1_strided(int M, int N, T alpha, const T *x, ptrdiff_t incx,
+                   const T *y, ptrdiff_t incy, T beta, T *C, int ldc);
+
+#endif
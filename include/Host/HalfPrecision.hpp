@@ -0,0 +1,100 @@
+#ifndef __HALF_PRECISION__
+#define __HALF_PRECISION__
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// 16-bit storage formats for matrices. Values are only stored in these
+// types; every kernel widens them to float and computes in float, which
+// halves the memory footprint and bandwidth of the operands without giving
+// up fp32 accumulation.
+//
+// float16 is IEEE 754 binary16 (5 exponent bits, 10 mantissa bits), exact
+// for integers up to 2048 and with a largest finite value of 65504. bfloat16
+// is the upper half of a float (8 exponent bits, 7 mantissa bits): the range
+// of float with about three significant digits. Narrowing rounds to nearest
+// even in both cases.
+struct float16 {
+    uint16_t bits;
+};
+
+struct bfloat16 {
+    uint16_t bits;
+};
+
+inline uint32_t float_bits(float f) {
+    uint32_t u;
+    std::memcpy(&u, &f, sizeof(u));
+    return u;
+}
+
+inline float bits_float(uint32_t u) {
+    float f;
+    std::memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+inline float half_to_float(float16 h) {
+    const uint32_t shifted_exp = 0x7c00u << 13;
+    uint32_t bits = (uint32_t)(h.bits & 0x7fffu) << 13;
+    uint32_t exp = bits & shifted_exp;
+
+    bits += (127u - 15u) << 23;
+    if (exp == shifted_exp) {
+        // Inf and NaN keep an all ones exponent
+        bits += (128u - 16u) << 23;
+    } else if (exp == 0) {
+        // Zero and subnormals, renormalized by a float subtraction
+        bits += 1u << 23;
+        bits = float_bits(bits_float(bits) - bits_float(113u << 23));
+    }
+    return bits_float(bits | (uint32_t)(h.bits & 0x8000u) << 16);
+}
+
+inline float16 float_to_half(float f) {
+    uint32_t bits = float_bits(f);
+    uint32_t sign = bits & 0x80000000u;
+    bits ^= sign;
+
+    uint16_t h;
+    if (bits >= (127u + 16u) << 23) {
+        // Too large for binary16 (or Inf / NaN)
+        h = bits > 0x7f800000u ? 0x7e00 : 0x7c00;
+    } else if (bits < 113u << 23) {
+        // Subnormal result; the float addition does the rounding
+        const uint32_t magic = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+        h = (uint16_t)(float_bits(bits_float(bits) + bits_float(magic)) -
+                       magic);
+    } else {
+        uint32_t odd = (bits >> 13) & 1u;
+        bits += ((15u - 127u) << 23) + 0xfffu + odd;
+        h = (uint16_t)(bits >> 13);
+    }
+    return {(uint16_t)(h | sign >> 16)};
+}
+
+inline float bfloat16_to_float(bfloat16 b) {
+    return bits_float((uint32_t)b.bits << 16);
+}
+
+inline bfloat16 float_to_bfloat16(float f) {
+    uint32_t bits = float_bits(f);
+    if ((bits & 0x7fffffffu) > 0x7f800000u) {
+        // Quiet the NaN so that truncation cannot turn it into Inf
+        return {(uint16_t)(bits >> 16 | 0x40u)};
+    }
+    bits += 0x7fffu + ((bits >> 16) & 1u);
+    return {(uint16_t)(bits >> 16)};
+}
+
+// Bulk conversions between float arrays and the 16-bit formats. They use
+// F16C, AVX-512 BF16 or the NEON conversion instructions when the CPU has
+// them and the scalar conversions above otherwise, with identical results
+// except that AVX-512 BF16 flushes subnormal inputs to zero.
+void convert_to_float(const float16 *src, float *dst, size_t count);
+void convert_to_float(const bfloat16 *src, float *dst, size_t count);
+void convert_from_float(const float *src, float16 *dst, size_t count);
+void convert_from_float(const float *src, bfloat16 *dst, size_t count);
+
+#endif
@@ -0,0 +1,292 @@
+#ifndef __HOST_GEMM__
+#define __HOST_GEMM__
+
+#include <Host/HalfPrecision.hpp>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+
+// Host (CPU) matrix multiply engine. This is the reference the Metal results
+// are verified against, so it has to stay fast for large matrices as well.
+//
+// All matrices are row-major. The engine follows the usual GotoBLAS layout:
+// a KC x NC panel of B is packed to stay resident in L3, an MC x KC block of A
+// is packed to stay resident in L2, and a micro-kernel computes MR x NR tiles
+// of C in registers while streaming the packed panels out of L1. Large
+// products are split into 2D tiles of C that are load balanced over the
+// persistent host thread pool (see WorkStealingScheduler.hpp).
+
+struct GemmBlocking {
+    int mr; // Rows of the register tile
+    int nr; // Columns of the register tile
+    int mc; // Rows of the packed A block (L2)
+    int kc; // Depth of the packed A/B panels (L1/L2)
+    int nc; // Columns of the packed B panel (L3)
+};
+
+// Blocking parameters of the micro-kernel selected for this CPU
+GemmBlocking host_gemm_blocking();
+
+// Name of the micro-kernel selected for this CPU ("avx512", "avx2", ...)
+const char *host_gemm_kernel_name();
+
+// How single products (sgemm, host_matrix_multiply) are spread over the
+// thread pool. Batched and grouped calls always tile every member.
+enum class GemmSchedule {
+    // SplitK for reduction-heavy shapes (small M x N, K much larger than M
+    // and N), Tiled otherwise. The choice depends on the shape only.
+    Auto,
+    // 2D tiles of C, each computed over the full K
+    Tiled,
+    // K is cut into chunks whose partial products are combined in a fixed
+    // order tree, which keeps small M x N outputs with a huge K busy on all
+    // cores. Results are bitwise identical for any thread count. The partial
+    // products take a workspace of up to 64 MiB per calling thread.
+    SplitK,
+    // Every worker gets an equal share of all multiply-add iterations,
+    // crossing tile boundaries, and split tiles are fixed up afterwards. Tile
+    // counts that do not divide by the worker count leave no ragged wave.
+    StreamK,
+};
+
+// Selects the schedule for subsequent calls. The initial value comes from
+// HOST_GEMM_SCHEDULE (auto, tiled, splitk or streamk) and defaults to Auto.
+void host_gemm_set_schedule(GemmSchedule schedule);
+
+GemmSchedule host_gemm_schedule();
+
+// BLAS-style single precision GEMM on row-major matrices:
+//     C = alpha * op(A) * op(B) + beta * C
+// where op(X) is X for trans = 'N' and X^T for trans = 'T' (or 'C'). op(A) is
+// M x K, op(B) is K x N and C is M x N. Transposes are absorbed by the packing
+// routines and beta by the micro-kernel's store, so no pass over memory is
+// added for either. Products with M, N or K equal to 1 are routed to the
+// GEMV and rank-1 kernels of Gemv.hpp. C is not read when beta is zero. Throws
+// std::invalid_argument on invalid flags, dimensions or leading dimensions.
+void sgemm(char transA, char transB, int M, int N, int K, float alpha,
+           const float *A, int lda, const float *B, int ldb, float beta,
+           float *C, int ldc);
+
+// Many sgemm products of one shape in a single call:
+//     C_i = alpha * op(A_i) * op(B_i) + beta * C_i,   i = 0 .. batch - 1
+// with A_i = A + i * strideA and likewise for B and C (strides in elements).
+// A stride of 0 broadcasts that operand to every member. All members run as
+// one parallel region on the host thread pool. Throws std::invalid_argument
+// for the sgemm conditions, a negative batch or overlapping outputs.
+void sgemm_strided_batched(char transA, char transB, int M, int N, int K,
+                           float alpha, const float *A, int lda,
+                           ptrdiff_t strideA, const float *B, int ldb,
+                           ptrdiff_t strideB, float beta, float *C, int ldc,
+                           ptrdiff_t strideC, int batch);
+
+// Arguments of one sgemm call, for sgemm_grouped
+struct GemmDescriptor {
+    char transA;
+    char transB;
+    int M;
+    int N;
+    int K;
+    float alpha;
+    const float *A;
+    int lda;
+    const float *B;
+    int ldb;
+    float beta;
+    float *C;
+    int ldc;
+};
+
+// Runs `count` independent sgemm products of arbitrary shapes as one
+// load-balanced parallel region: the tiles of all problems are scheduled
+// together, so small problems do not leave cores idle. The outputs must not
+// overlap. Arguments are validated as for sgemm before any work starts.
+void sgemm_grouped(const GemmDescriptor *problems, int count);
+
+// B operand packed into the micro-kernel's layout, see sgemm_pack_b
+class PackedMatrixB;
+
+// Packs op(B) (K x N, see sgemm for transB and ldb) once into the panel
+// layout of the selected micro-kernel and returns an opaque, immutable handle
+// that can be shared between threads. Multiplies through sgemm_packed then
+// skip packing B entirely, which pays off when the same B (e.g. a weight
+// matrix) is multiplied against a stream of different A matrices.
+std::shared_ptr<const PackedMatrixB> sgemm_pack_b(char transB, int K, int N,
+                                                   const float *B, int ldb);
+
+// Rows (K) and columns (N) of a packed B
+int packed_b_rows(const PackedMatrixB &packedB);
+int packed_b_cols(const PackedMatrixB &packedB);
+
+// sgemm with a pre-packed B: C = alpha * op(A) * B + beta * C where op(A) is
+// M x K and B is the K x N matrix packed by sgemm_pack_b
+void sgemm_packed(char transA, int M, float alpha, const float *A, int lda,
+                  const PackedMatrixB &packedB, float beta, float *C,
+                  int ldc);
+
+// Elementwise activation of a GemmEpilogue. The values match the
+// GEMM_ACTIVATION_* constants shared with the Metal kernel.
+enum class GemmActivation {
+    None = 0,
+    ReLU = 1,
+    // tanh approximation, 0.5 x (1 + tanh(sqrt(2 / pi) (x + 0.044715 x^3))),
+    // which is what the Metal kernel computes as well
+    GELU = 2,
+};
+
+// One real value through the activation
+template <class T> inline T gemm_activate(GemmActivation activation, T x) {
+    switch (activation) {
+    case GemmActivation::ReLU:
+        return x > T(0) ? x : T(0);
+    case GemmActivation::GELU:
+        return T(0.5f) * x *
+               (T(1) + std::tanh(T(0.7978845608f) *
+                                 (x + T(0.044715f) * x * x * x)));
+    default:
+        return x;
+    }
+}
+
+// Work fused into the store of a GEMM, applied to every element of C in
+// this order once the product is complete:
+//     C[i][j] = act((alpha * AB + beta * C)[i][j] * scale[j] + bias[j])
+//               + residual[i * ldr + j]
+// Every stage is optional; null pointers are skipped. The epilogue runs on
+// each register tile right after its last K block is stored, while the tile
+// is still in L1, so none of it costs an extra pass over C. residual must
+// not overlap C. GemmEpilogueOf<T> is the epilogue of a product with
+// elements of type T (see TypedGemm.hpp for the other types).
+template <class T> struct GemmEpilogueOf {
+    const T *scale = nullptr; // N per-column multipliers
+    const T *bias = nullptr;  // N per-column biases
+    GemmActivation activation = GemmActivation::None;
+    const T *residual = nullptr; // M x N, row stride ldr
+    int ldr = 0;
+};
+
+typedef GemmEpilogueOf<float> GemmEpilogue;
+
+// Throws std::invalid_argument when the epilogue of an N column product has
+// a residual with ldr smaller than N, or an activation on complex elements.
+// Shared by the host and device paths; instantiated for float, double,
+// std::complex<float> and std::complex<double>.
+template <class T>
+void check_epilogue(const GemmEpilogueOf<T> &epilogue, int N);
+
+// sgemm followed by a fused epilogue (see GemmEpilogue). Throws
+// std::invalid_argument for the sgemm conditions or when ldr is smaller
+// than N for a given residual.
+void sgemm_epilogue(char transA, char transB, int M, int N, int K, float alpha,
+                    const float *A, int lda, const float *B, int ldb,
+                    float beta, float *C, int ldc,
+                    const GemmEpilogue &epilogue);
+
+// sgemm_packed followed by a fused epilogue, e.g. a linear layer with packed
+// weights, bias and activation in one call
+void sgemm_packed(char transA, int M, float alpha, const float *A, int lda,
+                  const PackedMatrixB &packedB, float beta, float *C, int ldc,
+                  const GemmEpilogue &epilogue);
+
+// B operand quantized to 4 bits, see int4_pack_b
+class Int4MatrixB;
+
+// Quantizes op(B) (K x N, see sgemm for transB and ldb) to 4 bits for
+// weight-only quantized products. Every groupSize consecutive rows of a
+// column form a group with its own scale and zero point, fitted to the
+// group's range: w = scale * (q - zero) with q and zero in [0, 15]. The
+// result takes an eighth of the memory of the floats plus one scale and
+// zero point per group. Throws std::invalid_argument for the sgemm
+// conditions or a groupSize below 1.
+std::shared_ptr<const Int4MatrixB> int4_pack_b(char transB, int K, int N,
+                                               const float *B, int ldb,
+                                               int groupSize);
+
+// Rows (K) and columns (N) of a 4-bit B
+int int4_b_rows(const Int4MatrixB &packedB);
+int int4_b_cols(const Int4MatrixB &packedB);
+
+// Writes the dequantized K x N values of a 4-bit B to B (row stride ldb)
+void int4_unpack_b(const Int4MatrixB &packedB, float *B, int ldb);
+
+// C = alpha * op(A) * B + beta * C with float A and C, op(A) M x K and the
+// K x N matrix B quantized by int4_pack_b. B is dequantized inside the
+// packing step, so the micro-kernel runs on floats as usual. Up to 8 rows
+// of A skip packing and stream the 4-bit values once instead, which keeps
+// memory traffic at the quantized size where it matters most.
+void sgemm_int4(char transA, int M, float alpha, const float *A, int lda,
+                const Int4MatrixB &packedB, float beta, float *C, int ldc);
+
+// sgemm_int4 followed by a fused epilogue
+void sgemm_int4(char transA, int M, float alpha, const float *A, int lda,
+                const Int4MatrixB &packedB, float beta, float *C, int ldc,
+                const GemmEpilogue &epilogue);
+
+// Matrix in a microscaling block format, see Microscaling.hpp
+class MxMatrix;
+
+// C = alpha * op(A) * op(B) + beta * C with A and B in an MX format, op as
+// for sgemm. The dimensions come from the matrices: op(A) is M x K and op(B)
+// K x N. The blocks are decoded straight into the micro-kernel's packed
+// panels, one cache block at a time, so the operands are never expanded to
+// float as a whole and their memory traffic stays at about a quarter of
+// sgemm's. Products and accumulation are in float. Throws
+// std::invalid_argument for the sgemm conditions or when the inner
+// dimensions differ.
+void sgemm_mx(char transA, char transB, float alpha, const MxMatrix &A,
+              const MxMatrix &B, float beta, float *C, int ldc);
+
+// As above with a float A (M x K after transA, row stride lda), e.g.
+// activations against MX weights
+void sgemm_mx(char transA, char transB, int M, float alpha, const float *A,
+              int lda, const MxMatrix &B, float beta, float *C, int ldc);
+
+// sgemm with A and B stored as float16 or bfloat16 (see HalfPrecision.hpp).
+// Blocks of both operands are widened to float as they are packed, so the
+// operands take half the memory and bandwidth of sgemm's while products and
+// accumulation stay in float; the result is that of sgemm on the widened
+// inputs. C is float. Throws as sgemm.
+void sgemm_f16(char transA, char transB, int M, int N, int K, float alpha,
+               const float16 *A, int lda, const float16 *B, int ldb,
+               float beta, float *C, int ldc);
+
+void sgemm_bf16(char transA, char transB, int M, int N, int K, float alpha,
+                const bfloat16 *A, int lda, const bfloat16 *B, int ldb,
+                float beta, float *C, int ldc);
+
+// Symmetric rank-k update of one triangle of the N x N matrix C:
+//     C = alpha * A * A^T + beta * C   for trans = 'N', A is N x K
+//     C = alpha * A^T * A + beta * C   for trans = 'T', A is K x N
+// Only the triangle selected by uplo ('L' lower or 'U' upper, diagonal
+// included) is computed, read and written, which is about half the work
+// and write traffic of sgemm. The other triangle is left untouched; see
+// mirror_triangle for a full matrix. Throws std::invalid_argument on invalid
+// flags, dimensions or leading dimensions.
+void ssyrk(char uplo, char trans, int N, int K, float alpha, const float *A,
+           int lda, float beta, float *C, int ldc);
+
+// Symmetric rank-2k update of one triangle of C, with A and B shaped alike:
+//     C = alpha * (A * B^T + B * A^T) + beta * C   for trans = 'N'
+//     C = alpha * (A^T * B + B^T * A) + beta * C   for trans = 'T'
+void ssyr2k(char uplo, char trans, int N, int K, float alpha, const float *A,
+            int lda, const float *B, int ldb, float beta, float *C, int ldc);
+
+// Copies the uplo triangle of the N x N matrix C onto the other one, making
+// C symmetric. Runs as a cache blocked transpose on the thread pool.
+void mirror_triangle(char uplo, int N, float *C, int ldc);
+
+// C = A * B where A is M x K, B is K x N and C is M x N. lda, ldb and ldc
+// are the row strides (in elements) of the three matrices, so sub-matrices of
+// larger buffers can be used in place. T is float (sgemm), double (dgemm),
+// std::complex<float> (cgemm) or std::complex<double> (zgemm), see
+// TypedGemm.hpp for the last three. Throws std::invalid_argument when a
+// dimension is negative or a leading dimension is smaller than its row.
+template <class T>
+void host_matrix_multiply(const T *matA, const T *matB, T *matC, int M, int N,
+                          int K, int lda, int ldb, int ldc);
+
+// As above for densely packed matrices (lda = K, ldb = N, ldc = N)
+template <class T>
+void host_matrix_multiply(const T *matA, const T *matB, T *matC, int M, int N,
+                          int K);
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef __MATRIX_CHAIN__
+#define __MATRIX_CHAIN__
+
+// Products of three or more matrices, C = M_0 * M_1 * ... * M_{count - 1}.
+//
+// The multiplication order is chosen by the classic O(count^3) dynamic
+// program over the shapes, minimizing the total number of multiply-adds; the
+// written order of a chain can cost orders of magnitude more. The resulting
+// tree is evaluated bottom up: all products whose operands are ready are
+// independent and run as one sgemm_grouped call, so small subproducts share
+// the thread pool instead of running one after another. Intermediates live
+// in a few workspace buffers that are recycled as soon as their consumer has
+// run, and the last product writes straight into C.
+
+// One matrix of a chain: rows x cols, row-major with row stride ld
+struct ChainMatrix {
+    const float *data;
+    int rows;
+    int cols;
+    int ld;
+};
+
+// C = matrices[0] * ... * matrices[count - 1], where C has the rows of the
+// first and the columns of the last matrix and row stride ldc. Workspace is
+// reused by the calling thread across calls. Throws std::invalid_argument
+// when count is below 1, a dimension is negative, neighbouring shapes do
+// not match or a leading dimension is smaller than its row.
+void matrix_chain_multiply(const ChainMatrix *matrices, int count, float *C,
+                           int ldc);
+
+// Multiply-adds of the order matrix_chain_multiply would pick
+double matrix_chain_cost(const ChainMatrix *matrices, int count);
+
+#endif
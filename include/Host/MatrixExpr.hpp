@@ -0,0 +1,521 @@
+#ifndef __MATRIX_EXPR__
+#define __MATRIX_EXPR__
+
+#include <Host/HostGemm.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+// Lazy matrix expressions over plain row-major float buffers, e.g.
+//
+//     MatrixView C(matC, M, N, ldc);
+//     C = alpha * (A * B) + beta * C + row_broadcast(bias, N);
+//     C = relu(A * transpose(W) + row_broadcast(bias, N)) + X;
+//     C = 0.5f * (X + Y);
+//
+// Operators only build a small expression object; all work happens when it
+// is assigned to a MatrixView. An expression with one product whose other
+// terms fit the GEMM epilogue - the destination itself (beta), a row
+// broadcast bias, one activation around all of these and one residual
+// matrix added after it - is lowered to a single sgemm_epilogue call, so
+// there is no temporary and no extra pass over C. Expressions without a
+// product are evaluated in one loop over the destination that the compiler
+// can vectorize. Scaled operands of a product, such as (2 * A) * B or
+// transpose(-A) * B, fold their factor into alpha. Anything else (several
+// products, a sum as an operand, a product whose operand is the
+// destination, ...) still works: non-view operands and the products are
+// computed into temporaries first.
+//
+// The destination may be used inside the expression as long as it is not
+// transposed; every element is read before it is written.
+
+template <class E> struct MatrixExpr {
+    const E &self() const { return static_cast<const E &>(*this); }
+};
+
+namespace matrix_expr_detail {
+
+// What an expression lowers to, collected while walking it. Terms are
+// "inside" when they sit under the activation.
+struct Lowering {
+    const float *dest = nullptr;
+    size_t dest_extent = 0;
+    int ldc = 1;
+
+    bool product = false;
+    char transA = 'N';
+    char transB = 'N';
+    int M = 0;
+    int N = 0;
+    int K = 0;
+    const float *A = nullptr;
+    int lda = 1;
+    const float *B = nullptr;
+    int ldb = 1;
+    float alpha = 0.0f;
+    float beta = 0.0f;
+    GemmEpilogue epilogue;
+    bool activated = false;
+    bool outside = false; // Product, beta or bias outside the activation
+
+    bool overlapsDest(const float *data, size_t extent) const {
+        auto lo = (uintptr_t)data;
+        auto dlo = (uintptr_t)dest;
+        return lo < dlo + dest_extent * sizeof(float) &&
+               dlo < lo + extent * sizeof(float);
+    }
+
+    bool valid() const { return product && !(activated && outside); }
+};
+
+// Owns the products of an expression that could not be lowered
+typedef std::vector<std::vector<float>> Temporaries;
+
+inline size_t extent(int rows, int cols, int ld) {
+    return rows > 0 && cols > 0 ? (size_t)(rows - 1) * ld + cols : 0;
+}
+
+} // namespace matrix_expr_detail
+
+// Read-only rows x cols view of a row-major buffer with row stride ld
+class ConstMatrixView : public MatrixExpr<ConstMatrixView> {
+  protected:
+    const float *m_data;
+    int m_rows;
+    int m_cols;
+    int m_ld;
+
+  public:
+    static constexpr bool has_product = false;
+
+    ConstMatrixView(const float *data, int rows, int cols, int ld)
+        : m_data(data), m_rows(rows), m_cols(cols), m_ld(ld) {
+        if (rows < 0 || cols < 0) {
+            throw std::invalid_argument(
+                "Matrix dimensions must not be negative");
+        }
+        if (ld < std::max(1, cols)) {
+            throw std::invalid_argument(
+                "Leading dimension is smaller than the matrix row");
+        }
+    }
+
+    ConstMatrixView(const float *data, int rows, int cols)
+        : ConstMatrixView(data, rows, cols, std::max(1, cols)) {}
+
+    const float *data() const { return m_data; }
+    int rows() const { return m_rows; }
+    int cols() const { return m_cols; }
+    int ld() const { return m_ld; }
+
+    float at(int i, int j) const { return m_data[(size_t)i * m_ld + j]; }
+
+    bool lower(matrix_expr_detail::Lowering &g, float coeff,
+               bool inside) const {
+        if (m_data == g.dest && m_ld == g.ldc) {
+            g.beta += coeff;
+            g.outside |= !inside;
+            return true;
+        }
+        // Anything else is the residual, which the epilogue adds last
+        if (inside || coeff != 1.0f || g.epilogue.residual ||
+            g.overlapsDest(m_data,
+                           matrix_expr_detail::extent(m_rows, m_cols, m_ld))) {
+            return false;
+        }
+        g.epilogue.residual = m_data;
+        g.epilogue.ldr = m_ld;
+        return true;
+    }
+
+    void prepare(matrix_expr_detail::Temporaries &) const {}
+};
+
+// Writable view, the destination of an assignment. Assigning evaluates the
+// expression into the viewed elements; it never rebinds the view.
+class MatrixView : public ConstMatrixView {
+  public:
+    MatrixView(float *data, int rows, int cols, int ld)
+        : ConstMatrixView(data, rows, cols, ld) {}
+
+    MatrixView(float *data, int rows, int cols)
+        : ConstMatrixView(data, rows, cols) {}
+
+    float *data() const { return const_cast<float *>(m_data); }
+
+    template <class E> MatrixView &operator=(const MatrixExpr<E> &expr);
+
+    MatrixView &operator=(const MatrixView &other) {
+        return *this = static_cast<const MatrixExpr<ConstMatrixView> &>(other);
+    }
+};
+
+// Transpose of a view, which only swaps how elements are addressed
+class TransposedView : public MatrixExpr<TransposedView> {
+    ConstMatrixView m_view;
+
+  public:
+    static constexpr bool has_product = false;
+
+    explicit TransposedView(const ConstMatrixView &view) : m_view(view) {}
+
+    const ConstMatrixView &source() const { return m_view; }
+    int rows() const { return m_view.cols(); }
+    int cols() const { return m_view.rows(); }
+
+    float at(int i, int j) const { return m_view.at(j, i); }
+
+    bool lower(matrix_expr_detail::Lowering &, float, bool) const {
+        return false;
+    }
+
+    void prepare(matrix_expr_detail::Temporaries &) const {}
+};
+
+// A length `cols` vector repeated for every row, such as a bias. It takes the
+// row count of whatever it is added to.
+class RowBroadcast : public MatrixExpr<RowBroadcast> {
+    const float *m_data;
+    int m_cols;
+
+  public:
+    static constexpr bool has_product = false;
+
+    RowBroadcast(const float *data, int cols) : m_data(data), m_cols(cols) {}
+
+    int rows() const { return -1; }
+    int cols() const { return m_cols; }
+
+    float at(int, int j) const { return m_data[j]; }
+
+    bool lower(matrix_expr_detail::Lowering &g, float coeff,
+               bool inside) const {
+        if (coeff != 1.0f || g.epilogue.bias) {
+            return false;
+        }
+        g.epilogue.bias = m_data;
+        g.outside |= !inside;
+        return true;
+    }
+
+    void prepare(matrix_expr_detail::Temporaries &) const {}
+};
+
+inline RowBroadcast row_broadcast(const float *data, int cols) {
+    return RowBroadcast(data, cols);
+}
+
+template <class E> class ScaledExpr : public MatrixExpr<ScaledExpr<E>> {
+    E m_expr;
+    float m_scale;
+
+  public:
+    static constexpr bool has_product = E::has_product;
+
+    ScaledExpr(const E &expr, float scale) : m_expr(expr), m_scale(scale) {}
+
+    const E &expr() const { return m_expr; }
+    float scale() const { return m_scale; }
+
+    int rows() const { return m_expr.rows(); }
+    int cols() const { return m_expr.cols(); }
+
+    float at(int i, int j) const { return m_scale * m_expr.at(i, j); }
+
+    bool lower(matrix_expr_detail::Lowering &g, float coeff,
+               bool inside) const {
+        return m_expr.lower(g, coeff * m_scale, inside);
+    }
+
+    void prepare(matrix_expr_detail::Temporaries &temps) const {
+        m_expr.prepare(temps);
+    }
+};
+
+inline TransposedView transpose(const ConstMatrixView &view) {
+    return TransposedView(view);
+}
+
+// (s * A)^T = s * A^T, which keeps the factor foldable into alpha
+inline ScaledExpr<TransposedView>
+transpose(const ScaledExpr<ConstMatrixView> &scaled) {
+    return ScaledExpr<TransposedView>(TransposedView(scaled.expr()),
+                                      scaled.scale());
+}
+
+// L + SIGN * R
+template <class L, class R, int SIGN>
+class SumExpr : public MatrixExpr<SumExpr<L, R, SIGN>> {
+    L m_left;
+    R m_right;
+
+  public:
+    static constexpr bool has_product = L::has_product || R::has_product;
+
+    SumExpr(const L &left, const R &right) : m_left(left), m_right(right) {
+        bool rows_match = left.rows() < 0 || right.rows() < 0 ||
+                          left.rows() == right.rows();
+        if (!rows_match || left.cols() != right.cols()) {
+            throw std::invalid_argument("Matrix shapes do not match");
+        }
+    }
+
+    int rows() const {
+        return m_left.rows() >= 0 ? m_left.rows() : m_right.rows();
+    }
+    int cols() const { return m_left.cols(); }
+
+    float at(int i, int j) const {
+        return SIGN > 0 ? m_left.at(i, j) + m_right.at(i, j)
+                        : m_left.at(i, j) - m_right.at(i, j);
+    }
+
+    bool lower(matrix_expr_detail::Lowering &g, float coeff,
+               bool inside) const {
+        return m_left.lower(g, coeff, inside) &&
+               m_right.lower(g, SIGN * coeff, inside);
+    }
+
+    void prepare(matrix_expr_detail::Temporaries &temps) const {
+        m_left.prepare(temps);
+        m_right.prepare(temps);
+    }
+};
+
+template <class E> class ActivationExpr : public MatrixExpr<ActivationExpr<E>> {
+    E m_expr;
+    GemmActivation m_activation;
+
+  public:
+    static constexpr bool has_product = E::has_product;
+
+    ActivationExpr(const E &expr, GemmActivation activation)
+        : m_expr(expr), m_activation(activation) {}
+
+    int rows() const { return m_expr.rows(); }
+    int cols() const { return m_expr.cols(); }
+
+    float at(int i, int j) const {
+        return gemm_activate(m_activation, m_expr.at(i, j));
+    }
+
+    bool lower(matrix_expr_detail::Lowering &g, float coeff,
+               bool inside) const {
+        if (inside || coeff != 1.0f || g.activated) {
+            return false;
+        }
+        g.activated = true;
+        g.epilogue.activation = m_activation;
+        return m_expr.lower(g, 1.0f, true);
+    }
+
+    void prepare(matrix_expr_detail::Temporaries &temps) const {
+        m_expr.prepare(temps);
+    }
+};
+
+template <class E> ActivationExpr<E> relu(const MatrixExpr<E> &expr) {
+    return ActivationExpr<E>(expr.self(), GemmActivation::ReLU);
+}
+
+template <class E> ActivationExpr<E> gelu(const MatrixExpr<E> &expr) {
+    return ActivationExpr<E>(expr.self(), GemmActivation::GELU);
+}
+
+namespace matrix_expr_detail {
+
+// A product operand as sgemm takes it, with a factor for alpha
+struct ProductOperand {
+    char trans = 'N';
+    const float *data = nullptr;
+    int ld = 1;
+    float scale = 1.0f;
+    size_t extent = 0; // Elements spanned, for the aliasing check
+};
+
+// Fills op when the expression can be passed to sgemm as it is: a view, its
+// transpose, or either of these scaled
+template <class E> bool as_operand(const E &, ProductOperand &) {
+    return false;
+}
+
+inline bool as_operand(const ConstMatrixView &view, ProductOperand &op) {
+    op.trans = 'N';
+    op.data = view.data();
+    op.ld = view.ld();
+    op.extent = extent(view.rows(), view.cols(), view.ld());
+    return true;
+}
+
+inline bool as_operand(const TransposedView &view, ProductOperand &op) {
+    as_operand(view.source(), op);
+    op.trans = 'T';
+    return true;
+}
+
+template <class E>
+bool as_operand(const ScaledExpr<E> &scaled, ProductOperand &op) {
+    if (!as_operand(scaled.expr(), op)) {
+        return false;
+    }
+    op.scale *= scaled.scale();
+    return true;
+}
+
+// The operand itself if sgemm can take it, otherwise its value evaluated
+// into a dense temporary
+template <class E>
+ProductOperand evaluate_operand(const E &e, Temporaries &temps) {
+    ProductOperand op;
+    if (as_operand(e, op)) {
+        return op;
+    }
+    e.prepare(temps);
+    int ld = std::max(1, e.cols());
+    temps.emplace_back(std::max<size_t>(1, (size_t)e.rows() * ld));
+    float *data = temps.back().data();
+    for (int i = 0; i < e.rows(); ++i) {
+        for (int j = 0; j < e.cols(); ++j) {
+            data[(size_t)i * ld + j] = e.at(i, j);
+        }
+    }
+    op = ProductOperand();
+    op.data = data;
+    op.ld = ld;
+    op.extent = extent(e.rows(), e.cols(), ld);
+    return op;
+}
+
+} // namespace matrix_expr_detail
+
+// Matrix product of two expressions
+template <class L, class R>
+class ProductExpr : public MatrixExpr<ProductExpr<L, R>> {
+    L m_left;
+    R m_right;
+    mutable const float *m_result = nullptr; // Set by prepare
+
+  public:
+    static constexpr bool has_product = true;
+
+    ProductExpr(const L &left, const R &right)
+        : m_left(left), m_right(right) {
+        if (left.rows() < 0 || left.cols() != right.rows()) {
+            throw std::invalid_argument("Matrix shapes do not match");
+        }
+    }
+
+    int rows() const { return m_left.rows(); }
+    int cols() const { return m_right.cols(); }
+
+    float at(int i, int j) const {
+        return m_result[(size_t)i * cols() + j];
+    }
+
+    bool lower(matrix_expr_detail::Lowering &g, float coeff,
+               bool inside) const {
+        using namespace matrix_expr_detail;
+
+        ProductOperand a, b;
+        if (g.product || !as_operand(m_left, a) || !as_operand(m_right, b) ||
+            g.overlapsDest(a.data, a.extent) ||
+            g.overlapsDest(b.data, b.extent)) {
+            return false;
+        }
+        g.product = true;
+        g.transA = a.trans;
+        g.A = a.data;
+        g.lda = a.ld;
+        g.transB = b.trans;
+        g.B = b.data;
+        g.ldb = b.ld;
+        g.M = rows();
+        g.N = cols();
+        g.K = m_left.cols();
+        g.alpha = coeff * a.scale * b.scale;
+        g.outside |= !inside;
+        return true;
+    }
+
+    void prepare(matrix_expr_detail::Temporaries &temps) const {
+        using namespace matrix_expr_detail;
+        ProductOperand a = evaluate_operand(m_left, temps);
+        ProductOperand b = evaluate_operand(m_right, temps);
+
+        temps.emplace_back(std::max<size_t>(1, (size_t)rows() * cols()));
+        float *C = temps.back().data();
+        sgemm(a.trans, b.trans, rows(), cols(), m_left.cols(),
+              a.scale * b.scale, a.data, a.ld, b.data, b.ld, 0.0f, C,
+              std::max(1, cols()));
+        m_result = C;
+    }
+};
+
+template <class L, class R>
+ProductExpr<L, R> operator*(const MatrixExpr<L> &left,
+                            const MatrixExpr<R> &right) {
+    return ProductExpr<L, R>(left.self(), right.self());
+}
+
+template <class E>
+ScaledExpr<E> operator*(float scale, const MatrixExpr<E> &expr) {
+    return ScaledExpr<E>(expr.self(), scale);
+}
+
+template <class E>
+ScaledExpr<E> operator*(const MatrixExpr<E> &expr, float scale) {
+    return ScaledExpr<E>(expr.self(), scale);
+}
+
+template <class E> ScaledExpr<E> operator-(const MatrixExpr<E> &expr) {
+    return ScaledExpr<E>(expr.self(), -1.0f);
+}
+
+template <class L, class R>
+SumExpr<L, R, 1> operator+(const MatrixExpr<L> &left,
+                           const MatrixExpr<R> &right) {
+    return SumExpr<L, R, 1>(left.self(), right.self());
+}
+
+template <class L, class R>
+SumExpr<L, R, -1> operator-(const MatrixExpr<L> &left,
+                            const MatrixExpr<R> &right) {
+    return SumExpr<L, R, -1>(left.self(), right.self());
+}
+
+template <class E>
+MatrixView &MatrixView::operator=(const MatrixExpr<E> &expr) {
+    using namespace matrix_expr_detail;
+    const E &e = expr.self();
+
+    if ((e.rows() >= 0 && e.rows() != rows()) || e.cols() != cols()) {
+        throw std::invalid_argument("Matrix shapes do not match");
+    }
+
+    Temporaries temps;
+    if (E::has_product) {
+        Lowering g;
+        g.dest = m_data;
+        g.dest_extent = extent(rows(), cols(), ld());
+        g.ldc = ld();
+        if (e.lower(g, 1.0f, false) && g.valid()) {
+            sgemm_epilogue(g.transA, g.transB, g.M, g.N, g.K, g.alpha, g.A,
+                           g.lda, g.B, g.ldb, g.beta, data(), ld(),
+                           g.epilogue);
+            return *this;
+        }
+        e.prepare(temps);
+    }
+
+    float *dst = data();
+    for (int i = 0; i < rows(); ++i) {
+        float *row = dst + (size_t)i * ld();
+        for (int j = 0; j < cols(); ++j) {
+            row[j] = e.at(i, j);
+        }
+    }
+    return *this;
+}
+
+#endif
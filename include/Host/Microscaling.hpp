@@ -0,0 +1,81 @@
+#ifndef __MICROSCALING__
+#define __MICROSCALING__
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Microscaling (MX) block floating point, after the OCP MX specification.
+// Every row of a matrix is cut into blocks of MX_BLOCK consecutive values
+// that share one power of two scale X, stored as a biased 8-bit exponent
+// (E8M0: X = 2^(e - 127)). The values themselves are 8-bit elements:
+//
+//   Int8     MXINT8, two's complement fixed point with 6 fraction bits,
+//            x = X * q / 64 for q in [-127, 127]
+//   Fp8E4M3  MXFP8, 8-bit float with 4 exponent and 3 mantissa bits,
+//            largest magnitude 448, x = X * fp8
+//
+// A block takes 33 bytes for 32 floats, a little under a quarter of their
+// memory. X is derived from the block's largest magnitude as the spec
+// prescribes, except that an E4M3 block whose largest element would exceed
+// 448 takes the next power of two instead of saturating. Elements round to
+// nearest even.
+//
+// Blocks run along the rows of the stored matrix. For GEMM operands the
+// blocks should lie along the reduction dimension: encode A (M x K) and B^T
+// (N x K), and multiply with transB = 'T'. The other orientations work as
+// well, but then a scale is shared across k instead of within a dot product.
+
+constexpr int MX_BLOCK = 32;
+
+enum class MxElement {
+    Int8,
+    Fp8E4M3,
+};
+
+// rows x cols matrix in an MX format. Row r holds blocks_per_row blocks,
+// each MX_BLOCK element codes in elements and one exponent in scales;
+// columns past cols are zero codes.
+class MxMatrix {
+  public:
+    int rows;
+    int cols;
+    MxElement element;
+    int blocks_per_row;
+    std::vector<uint8_t> elements; // rows * blocks_per_row * MX_BLOCK codes
+    std::vector<uint8_t> scales;   // rows * blocks_per_row E8M0 exponents
+
+    const uint8_t *row_elements(int r) const {
+        return elements.data() + (size_t)r * blocks_per_row * MX_BLOCK;
+    }
+
+    const uint8_t *row_scales(int r) const {
+        return scales.data() + (size_t)r * blocks_per_row;
+    }
+
+    // Storage in bytes, elements and scales
+    size_t bytes() const { return elements.size() + scales.size(); }
+};
+
+// Encodes the rows x cols float matrix X (row stride ldx) into MX blocks.
+// X has to be finite. Throws std::invalid_argument on negative dimensions or
+// a leading dimension smaller than cols.
+std::shared_ptr<const MxMatrix> mx_encode(MxElement element, int rows,
+                                          int cols, const float *X, int ldx);
+
+// Decodes the whole matrix into X (row stride ldx)
+void mx_decode(const MxMatrix &mx, float *X, int ldx);
+
+// Decodes the n values of row r starting at column col into dst. This is the
+// kernel the GEMM packing routines call on every block they pack.
+void mx_decode_row(const MxMatrix &mx, int r, int col, int n, float *dst);
+
+// out[i] = sum_k A[i * lda + k] * X(r, k) over the whole of row r, for the
+// m rows of A. Blocks are decoded into registers and multiplied straight
+// into the sums, so none of the row is written out; this is what sgemm_mx
+// streams an MX B^T against a few rows of A with.
+void mx_dot_row(const MxMatrix &mx, int r, int m, const float *A, int lda,
+                float *out);
+
+#endif
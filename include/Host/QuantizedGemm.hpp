@@ -0,0 +1,104 @@
+#ifndef __QUANTIZED_GEMM__
+#define __QUANTIZED_GEMM__
+
+#include <cstdint>
+#include <memory>
+
+// int8 GEMM with exact int32 accumulation. An int8 value q stands for the
+// real number scale * (q - zeroPoint). A is quantized per tensor and may
+// carry a zero point (activations); B is quantized symmetrically, per tensor
+// or with one scale per output column (weights, "per channel").
+//
+// B is packed once per call into panels of four consecutive k values per
+// column, the layout of the AVX-512 VNNI dot product instruction, which
+// multiplies 64 unsigned by signed byte pairs into 16 int32 sums at a time.
+// A is offset by 128 into unsigned bytes while it is packed and the offset
+// is folded, together with A's zero point, into a per column correction of
+// B's column sums. CPUs without VNNI run a portable kernel on the same
+// layout. Dequantization or requantization is fused into the store of each
+// register tile, so C is written exactly once. Packing B costs about as
+// much as a GEMV, so products with only a few rows of A are bound by it;
+// constant weights should be packed once with int8_pack_b instead.
+//
+// K is limited to 65536, which keeps every int32 accumulator exact.
+
+struct QuantParams {
+    float scale = 1.0f;
+    int zeroPoint = 0;
+};
+
+// Scales of the operands of a quantized GEMM. b has N entries when
+// perChannel is set and a single one otherwise.
+struct QuantizedGemmScales {
+    QuantParams a;
+    const float *b = nullptr;
+    bool perChannel = false;
+};
+
+// Asymmetric per tensor quantization of a rows x cols float matrix X into
+// Q, mapping the range [min(X, 0), max(X, 0)] onto [-128, 127]. Returns the
+// scale and zero point used.
+QuantParams quantize_tensor(int rows, int cols, const float *X, int ldx,
+                            int8_t *Q, int ldq);
+
+// Symmetric quantization of every column of a rows x cols float matrix X
+// into Q with its own scale (max |x| / 127), written to scales[cols]. This
+// is the usual per channel quantization of a K x N weight matrix.
+void quantize_columns(int rows, int cols, const float *X, int ldx, int8_t *Q,
+                      int ldq, float *scales);
+
+// Raw int32 product C = (op(A) - zeroA) * op(B), with op as for sgemm
+// (transA / transB of 'N' or 'T'), op(A) M x K and op(B) K x N. Throws
+// std::invalid_argument on invalid flags, dimensions, leading dimensions,
+// a zero point outside [-128, 127] or K above 65536.
+void qgemm_s32(char transA, char transB, int M, int N, int K, const int8_t *A,
+               int lda, int zeroA, const int8_t *B, int ldb, int32_t *C,
+               int ldc);
+
+// Product dequantized into float C:
+//     C[i][j] = scales.a.scale * scaleB[j] * acc[i][j] + bias[j]
+// where acc is the qgemm_s32 result and bias (N floats) may be null.
+void qgemm_dequantize(char transA, char transB, int M, int N, int K,
+                      const int8_t *A, int lda, const int8_t *B, int ldb,
+                      const QuantizedGemmScales &scales, const float *bias,
+                      float *C, int ldc);
+
+// Product requantized into int8 C with quantization c: the dequantized
+// value v becomes clamp(round(v / c.scale) + c.zeroPoint, -128, 127), with
+// ties rounded to even. Throws additionally for a non-positive c.scale.
+void qgemm_requantize(char transA, char transB, int M, int N, int K,
+                      const int8_t *A, int lda, const int8_t *B, int ldb,
+                      const QuantizedGemmScales &scales, const float *bias,
+                      QuantParams c, int8_t *C, int ldc);
+
+// B operand packed for the int8 kernels, see int8_pack_b
+class Int8MatrixB;
+
+// Packs op(B) (K x N, see qgemm_s32 for transB and ldb) once into the
+// kernel's panel layout together with its column sums, and returns an
+// immutable handle that can be shared between threads. Products through the
+// overloads below skip packing B, which pays off for weights multiplied
+// against a stream of activations. Throws like qgemm_s32.
+std::shared_ptr<const Int8MatrixB> int8_pack_b(char transB, int K, int N,
+                                               const int8_t *B, int ldb);
+
+// Rows (K) and columns (N) of a packed B
+int int8_b_rows(const Int8MatrixB &packedB);
+int int8_b_cols(const Int8MatrixB &packedB);
+
+// qgemm_s32, qgemm_dequantize and qgemm_requantize with a pre-packed B:
+// op(A) is M x K and B the K x N matrix packed by int8_pack_b
+void qgemm_s32(char transA, int M, const int8_t *A, int lda, int zeroA,
+               const Int8MatrixB &packedB, int32_t *C, int ldc);
+
+void qgemm_dequantize(char transA, int M, const int8_t *A, int lda,
+                      const Int8MatrixB &packedB,
+                      const QuantizedGemmScales &scales, const float *bias,
+                      float *C, int ldc);
+
+void qgemm_requantize(char transA, int M, const int8_t *A, int lda,
+                      const Int8MatrixB &packedB,
+                      const QuantizedGemmScales &scales, const float *bias,
+                      QuantParams c, int8_t *C, int ldc);
+
+#endif
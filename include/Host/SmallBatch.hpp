@@ -0,0 +1,40 @@
+#ifndef __SMALL_BATCH__
+#define __SMALL_BATCH__
+
+#include <cstddef>
+
+// Batches of tiny matrices (3x3, 4x4 transforms and the like) in an
+// interleaved array-of-structures-of-arrays (AoSoA) layout. Matrices are
+// grouped in blocks of AOSOA_LANES; within a block, element (i, j) of all
+// lanes is stored contiguously:
+//
+//     block[(i * cols + j) * AOSOA_LANES + lane]
+//
+// so a multiply can work on one element of AOSOA_LANES matrices with a single
+// vector operation, instead of trying to vectorize inside a 3x3 product.
+// The block size is fixed so the layout does not depend on the host CPU.
+
+constexpr int AOSOA_LANES = 16;
+
+// Number of floats needed to hold `count` rows x cols matrices in AoSoA form
+// (count is rounded up to whole blocks)
+size_t aosoa_size(int rows, int cols, size_t count);
+
+// Converts `count` densely packed row-major rows x cols matrices, stored one
+// after another as in the rest of the project, to AoSoA form. Unused lanes of
+// the last block are zero filled.
+void aosoa_pack(const float *src, int rows, int cols, size_t count,
+                float *dst);
+
+// Converts `count` matrices from AoSoA form back to plain row-major arrays
+void aosoa_unpack(const float *src, int rows, int cols, size_t count,
+                  float *dst);
+
+// C_i = A_i * B_i for `count` AoSoA matrices, A_i M x K, B_i K x N and C_i
+// M x N. Square 2x2, 3x3 and 4x4 products use fully unrolled kernels; all
+// kernels vectorize across the batch with the widest ISA the CPU supports.
+// Large batches are spread over the host thread pool.
+void aosoa_matrix_multiply(const float *A, const float *B, float *C, int M,
+                           int N, int K, size_t count);
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef __STRASSEN__
+#define __STRASSEN__
+
+// Opt-in Strassen-Winograd engine for large products. Each level of recursion
+// replaces the 8 half-size products of C = A * B with 7 products and 15
+// additions, which pays off once the matrices are large enough that the
+// additions (memory bound) are cheap next to the saved product. Recursion
+// stops when any dimension is at or below the crossover, and the remaining
+// products run on the blocked, multithreaded sgemm engine. Odd dimensions are
+// handled by peeling the last row/column and fixing it up with sgemm.
+//
+// Rounding differs from the classic algorithm: errors grow slightly with
+// every level, so prefer host_matrix_multiply for verification work.
+
+// Default crossover, sized so that the base products still keep all cores of
+// the sgemm engine busy
+constexpr int STRASSEN_DEFAULT_CROSSOVER = 2048;
+
+// C = A * B with A M x K, B K x N and C M x N, row-major with row strides
+// lda, ldb and ldc. All workspace for the recursion is taken in a single
+// allocation up front, reused by the calling thread across calls. Throws
+// std::invalid_argument for invalid dimensions or a crossover below 1.
+void strassen_matrix_multiply(const float *matA, const float *matB,
+                              float *matC, int M, int N, int K, int lda,
+                              int ldb, int ldc, int crossover);
+
+// As above with STRASSEN_DEFAULT_CROSSOVER
+void strassen_matrix_multiply(const float *matA, const float *matB,
+                              float *matC, int M, int N, int K, int lda,
+                              int ldb, int ldc);
+
+#endif
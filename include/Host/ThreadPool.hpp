@@ -0,0 +1,58 @@
+#ifndef __THREAD_POOL__
+#define __THREAD_POOL__
+
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Persistent pool of worker threads for the host kernels. Threads are created
+// once and parked on a condition variable between jobs, so back-to-back calls
+// only pay for a wake-up, never for thread creation or joining.
+//
+// The calling thread takes part in every job as worker 0. Jobs submitted from
+// inside a job, or while another thread owns the pool, run serially on the
+// calling thread instead of deadlocking.
+class ThreadPool {
+  private:
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::mutex m_run_mutex;
+    std::condition_variable m_start;
+    std::condition_variable m_done;
+    const std::function<void(int)> *m_job = nullptr;
+    uint64_t m_generation = 0;
+    int m_pending = 0;
+    bool m_stop = false;
+    std::exception_ptr m_error;
+
+    void workerLoop(int worker);
+    void runSerial(const std::function<void(int)> &job);
+
+  public:
+    explicit ThreadPool(int nthreads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    // Number of workers, including the calling thread
+    int size() const { return (int)m_threads.size() + 1; }
+
+    // Calls job(worker) once on every worker and waits for all of them. The
+    // first exception thrown by a worker is rethrown here.
+    void run(const std::function<void(int)> &job);
+
+    // Calls fn(task, worker) for every task in [0, ntasks). Each worker gets
+    // a contiguous range of tasks.
+    void parallelFor(int ntasks, const std::function<void(int, int)> &fn);
+
+    // Process-wide pool with one worker per hardware thread, or
+    // HOST_GEMM_THREADS workers when that is set in the environment
+    static ThreadPool &instance();
+};
+
+#endif
@@ -0,0 +1,81 @@
+#ifndef __TYPED_GEMM__
+#define __TYPED_GEMM__
+
+#include <Host/HostGemm.hpp>
+#include <complex>
+
+// GEMM in double precision and on complex matrices, with the conventions of
+// sgemm (see HostGemm.hpp): row-major matrices, C = alpha * op(A) * op(B) +
+// beta * C, C not read when beta is zero, std::invalid_argument on invalid
+// flags, dimensions or leading dimensions.
+//
+// All of them run on sgemm's blocked engine, with its schedules (see
+// host_gemm_set_schedule); dgemm also shares its GEMV and rank-1 routing of
+// degenerate shapes. dgemm uses the double precision micro-kernels of
+// GemmKernels.hpp. Complex products have no kernels of their own: blocks of
+// A and B are split into planes of real and imaginary parts while they are
+// packed, and every register tile is assembled from real products of the
+// planes on the micro-kernels of the component type (float for cgemm, double
+// for zgemm). How many real products that takes is a ComplexGemmMethod.
+
+enum class ComplexGemmMethod {
+    // Ar Br - Ai Bi + i (Ar Bi + Ai Br): four real products, rounding like a
+    // plain complex multiply-add
+    Standard,
+    // 3M: T1 = Ar Br, T2 = Ai Bi, T3 = (Ar + Ai)(Br + Bi) give Re = T1 - T2
+    // and Im = T3 - T1 - T2. Three real products, so a quarter fewer
+    // multiplies, but the error of Im is relative to (|Ar| + |Ai|)(|Br| +
+    // |Bi|) rather than to |Im|; small imaginary parts of large products lose
+    // digits.
+    ThreeM,
+};
+
+// Selects the method of subsequent complex products (cgemm, zgemm and the
+// complex host_matrix_multiply). The initial value comes from
+// HOST_GEMM_COMPLEX (4m or 3m) and defaults to Standard.
+void host_gemm_set_complex_method(ComplexGemmMethod method);
+
+ComplexGemmMethod host_gemm_complex_method();
+
+// Double precision GEMM. trans 'C' is the same as 'T'.
+void dgemm(char transA, char transB, int M, int N, int K, double alpha,
+           const double *A, int lda, const double *B, int ldb, double beta,
+           double *C, int ldc);
+
+// Complex GEMM. trans is 'N', 'T' or 'C', the last one being the conjugate
+// transpose op(X) = X^H.
+void cgemm(char transA, char transB, int M, int N, int K,
+           std::complex<float> alpha, const std::complex<float> *A, int lda,
+           const std::complex<float> *B, int ldb, std::complex<float> beta,
+           std::complex<float> *C, int ldc);
+
+void zgemm(char transA, char transB, int M, int N, int K,
+           std::complex<double> alpha, const std::complex<double> *A, int lda,
+           const std::complex<double> *B, int ldb, std::complex<double> beta,
+           std::complex<double> *C, int ldc);
+
+// dgemm, cgemm and zgemm followed by an epilogue (see GemmEpilogue in
+// HostGemm.hpp) with elements of the product's own type. dgemm fuses it into
+// the store of each register tile like sgemm_epilogue; complex products
+// apply it to each block of C as soon as the block is done. Activations are
+// not defined for complex values, so a complex epilogue with one throws
+// std::invalid_argument, as does a residual with ldr smaller than N.
+void dgemm_epilogue(char transA, char transB, int M, int N, int K,
+                    double alpha, const double *A, int lda, const double *B,
+                    int ldb, double beta, double *C, int ldc,
+                    const GemmEpilogueOf<double> &epilogue);
+
+void cgemm_epilogue(char transA, char transB, int M, int N, int K,
+                    std::complex<float> alpha, const std::complex<float> *A,
+                    int lda, const std::complex<float> *B, int ldb,
+                    std::complex<float> beta, std::complex<float> *C, int ldc,
+                    const GemmEpilogueOf<std::complex<float>> &epilogue);
+
+void zgemm_epilogue(char transA, char transB, int M, int N, int K,
+                    std::complex<double> alpha, const std::complex<double> *A,
+                    int lda, const std::complex<double> *B, int ldb,
+                    std::complex<double> beta, std::complex<double> *C,
+                    int ldc,
+                    const GemmEpilogueOf<std::complex<double>> &epilogue);
+
+#endif
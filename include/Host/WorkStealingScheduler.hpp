@@ -0,0 +1,30 @@
+#ifndef __WORK_STEALING_SCHEDULER__
+#define __WORK_STEALING_SCHEDULER__
+
+#include <Host/ThreadPool.hpp>
+#include <functional>
+
+// Dynamic load balancing on top of the ThreadPool. Every worker owns a deque
+// of task indices, seeded with an equal contiguous share. Workers take tasks
+// from the front of their own deque, which keeps neighbouring tiles on one
+// core, and when they run dry they steal the back half of another worker's
+// deque. Uneven tasks (edge tiles, skewed shapes, mixed batch members)
+// therefore end up spread over all cores instead of waiting on one.
+class WorkStealingScheduler {
+  private:
+    ThreadPool &m_pool;
+
+  public:
+    explicit WorkStealingScheduler(ThreadPool &pool) : m_pool(pool) {}
+
+    int size() const { return m_pool.size(); }
+
+    // Calls fn(task, worker) for every task in [0, ntasks) and waits for all
+    // of them. Exceptions propagate as for ThreadPool::run.
+    void parallelFor(int ntasks, const std::function<void(int, int)> &fn);
+
+    // Scheduler over ThreadPool::instance()
+    static WorkStealingScheduler &instance();
+};
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef __METAL_GEMM__
+#define __METAL_GEMM__
+
+#include <Host/HostGemm.hpp>
+#include <Metal/MetalGemmParams.h>
+
+// Device counterpart of sgemm_epilogue with alpha = 1 and beta = 0:
+// C = epilogue(A * B) through device_matrix_multiply from the metallib at
+// `lib`. The shape comes from params; its epilogue, activation and ldr fields
+// are filled in from `epilogue`, so the host and device results can be
+// compared directly. Arguments are validated as for sgemm_epilogue.
+void device_matrix_multiply(const char *lib, const float *matA,
+                            const float *matB, float *matC,
+                            const GemmParams &params,
+                            const GemmEpilogue &epilogue);
+
+// Device counterpart of sgemm_strided_batched: C_i = A_i * B_i for every
+// member of a strided batch described by params (see MetalGemmParams.h). The
+// whole batch shares one MetalContext, one set of buffers and one dispatch of
+// device_matrix_multiply_batched from the metallib at `lib`, so setup is paid
+// once per batch rather than once per product. Arguments are validated as
+// for sgemm_strided_batched, overlapping outputs included.
+void device_matrix_multiply_batched(const char *lib, const float *matA,
+                                    const float *matB, float *matC,
+                                    const GemmParams &params);
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef __METAL_GEMM_PARAMS__
+#define __METAL_GEMM_PARAMS__
+
+// Shape of a device GEMM, shared between the host and src/metal/matmul.metal
+// so that both sides agree on the layout of the constant buffer. Matrices are
+// row-major with row strides lda, ldb and ldc (in elements). Batched kernels
+// run `batch` products, member i reading A + i * strideA and so on; a stride
+// of 0 broadcasts an operand to every member.
+//
+// device_matrix_multiply can also run the host GemmEpilogue on every element
+// of C: `epilogue` holds GEMM_EPILOGUE_* flags for the inputs that are bound,
+// `activation` one of the GEMM_ACTIVATION_* values and `ldr` the row stride
+// of the residual.
+
+#ifndef __METAL_VERSION__
+#include <cstdint>
+#endif
+
+#define GEMM_EPILOGUE_SCALE 1u    // Per-column scale bound at buffer(4)
+#define GEMM_EPILOGUE_BIAS 2u     // Per-column bias bound at buffer(5)
+#define GEMM_EPILOGUE_RESIDUAL 4u // M x N residual bound at buffer(6)
+
+// Same values as the host GemmActivation
+#define GEMM_ACTIVATION_NONE 0u
+#define GEMM_ACTIVATION_RELU 1u
+#define GEMM_ACTIVATION_GELU 2u
+
+struct GemmParams {
+    uint32_t M;
+    uint32_t N;
+    uint32_t K;
+    uint32_t lda;
+    uint32_t ldb;
+    uint32_t ldc;
+    uint32_t batch;
+    uint32_t strideA;
+    uint32_t strideB;
+    uint32_t strideC;
+    uint32_t epilogue;
+    uint32_t activation;
+    uint32_t ldr;
+};
+
+#endif
@@ -1,11 +1,52 @@
 #ifndef __UTIL__
 #define __UTIL__
 
-void print_matrix(float *matrix, int nrows, int ncols);
+// The ld parameter is the row stride (leading dimension) of a row-major
+// matrix; the overloads without it assume densely packed rows (ld = ncols).
+// The templates are instantiated for float, double, std::complex<float> and
+// std::complex<double>; complex values are printed as a+bi and populated with
+// random real and imaginary parts.
 
-void populate_matrix(float *matrix, int nrows, int ncols);
+struct float16;
+struct bfloat16;
 
-bool compare_matrices(float *mat1, float *mat2, int nrows, int ncols);
+template <class T> void print_matrix(const T *matrix, int nrows, int ncols);
+
+template <class T>
+void print_matrix(const T *matrix, int nrows, int ncols, int ld);
+
+template <class T> void populate_matrix(T *matrix, int nrows, int ncols);
+
+template <class T>
+void populate_matrix(T *matrix, int nrows, int ncols, int ld);
+
+// The same values in 16-bit storage; both formats hold them exactly
+void populate_matrix(float16 *matrix, int nrows, int ncols);
+
+void populate_matrix(float16 *matrix, int nrows, int ncols, int ld);
+
+void populate_matrix(bfloat16 *matrix, int nrows, int ncols);
+
+void populate_matrix(bfloat16 *matrix, int nrows, int ncols, int ld);
+
+template <class T>
+bool compare_matrices(const T *mat1, const T *mat2, int nrows, int ncols);
+
+template <class T>
+bool compare_matrices(const T *mat1, int ld1, const T *mat2, int ld2,
+                      int nrows, int ncols);
+
+// As above, but elements only have to agree to within
+// tolerance * max(1, |reference|), with mat2 as the reference. For results of
+// reduced precision arithmetic (quantized or 16-bit operands) and for
+// comparing results whose rounding differs (3M against 4M complex products).
+template <class T>
+bool compare_matrices(const T *mat1, const T *mat2, int nrows, int ncols,
+                      double tolerance);
+
+template <class T>
+bool compare_matrices(const T *mat1, int ld1, const T *mat2, int ld2,
+                      int nrows, int ncols, double tolerance);
 
 void populate_standard_matrix(float *matrix);
 
@@ -0,0 +1,77 @@
+#include <Host/HostGemm.hpp>
+#include <Host/ThreadPool.hpp>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <stdio.h>
+#include <utils/util.hpp>
+
+// Compares the Tiled and StreamK host GEMM schedules on shapes whose tile
+// count does not divide evenly by the number of workers.
+
+#define REPEATS 5
+
+// Stream-K sums the K iterations of split tiles in a different order than
+// Tiled, so the results only agree up to rounding
+#define TOLERANCE 1e-4
+
+struct Shape {
+    int M;
+    int N;
+    int K;
+};
+
+static const Shape SHAPES[] = {
+    {517, 769, 1031}, {1000, 1000, 1000}, {1500, 300, 2000},
+    {129, 4100, 700}, {2049, 2049, 257},  {3000, 520, 1500},
+};
+
+// Best of REPEATS runs, in GFLOPS
+static double benchmark(GemmSchedule schedule, const Shape &shape,
+                        float *matA, float *matB, float *matC) {
+    host_gemm_set_schedule(schedule);
+
+    double best = 0.0;
+    for (int r = 0; r < REPEATS; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        host_matrix_multiply(matA, matB, matC, shape.M, shape.N, shape.K);
+        std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start;
+        best = std::max(best, 2.0 * shape.M * shape.N * shape.K /
+                                  elapsed.count() * 1e-9);
+    }
+    return best;
+}
+
+int main() {
+    printf("kernel %s, %d workers\n", host_gemm_kernel_name(),
+           ThreadPool::instance().size());
+    printf("%6s %6s %6s %12s %12s %8s\n", "M", "N", "K", "tiled GF/s",
+           "streamk GF/s", "speedup");
+
+    for (const Shape &shape : SHAPES) {
+        auto matA = std::make_unique<float[]>((size_t)shape.M * shape.K);
+        auto matB = std::make_unique<float[]>((size_t)shape.K * shape.N);
+        auto matC = std::make_unique<float[]>((size_t)shape.M * shape.N);
+        auto matS = std::make_unique<float[]>((size_t)shape.M * shape.N);
+
+        populate_matrix(matA.get(), shape.M, shape.K);
+        populate_matrix(matB.get(), shape.K, shape.N);
+
+        double tiled = benchmark(GemmSchedule::Tiled, shape, matA.get(),
+                                 matB.get(), matC.get());
+        double streamk = benchmark(GemmSchedule::StreamK, shape, matA.get(),
+                                   matB.get(), matS.get());
+
+        printf("%6d %6d %6d %12.1f %12.1f %7.2fx\n", shape.M, shape.N,
+               shape.K, tiled, streamk, streamk / tiled);
+
+        if (!compare_matrices(matS.get(), matC.get(), shape.M, shape.N,
+                              TOLERANCE)) {
+            std::cout << "Schedules disagree for this shape" << std::endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
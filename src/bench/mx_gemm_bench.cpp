@@ -0,0 +1,105 @@
+#include <Host/HostGemm.hpp>
+#include <Host/Microscaling.hpp>
+#include <Host/ThreadPool.hpp>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <stdio.h>
+#include <utils/util.hpp>
+
+// Compares sgemm_mx against sgemm on the float matrices the MX operands
+// were encoded from, for both element types, and times the encoder. A is
+// encoded as M x K and B as its transpose, so that blocks run along K. The
+// mixed column multiplies the float A with the MX B, the weight-only form
+// that small M products stream.
+
+#define REPEATS 5
+
+// Relative error allowed between the MX and the float result
+#define TOLERANCE 0.05
+
+struct Shape {
+    int M;
+    int N;
+    int K;
+};
+
+static const Shape SHAPES[] = {
+    {256, 256, 256}, {1000, 1000, 1000}, {64, 4096, 1024},
+    {8, 4096, 4096},   {1, 4096, 4096},
+};
+
+// Best of REPEATS runs, in seconds
+template <class Fn> static double best_time(Fn fn) {
+    double best = 1e30;
+    for (int r = 0; r < REPEATS; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count());
+    }
+    return best;
+}
+
+int main() {
+    printf("%d workers\n", ThreadPool::instance().size());
+    printf("%6s %6s %6s %8s %10s %10s %10s %10s %10s %10s\n", "M", "N", "K",
+           "element", "sgemm GF/s", "mx GF/s", "speedup", "mixed GF/s",
+           "speedup", "enc GB/s");
+
+    for (const Shape &shape : SHAPES) {
+        int M = shape.M, N = shape.N, K = shape.K;
+        auto matA = std::make_unique<float[]>((size_t)M * K);
+        auto matB = std::make_unique<float[]>((size_t)N * K);
+        auto matC = std::make_unique<float[]>((size_t)M * N);
+        auto matX = std::make_unique<float[]>((size_t)M * N);
+
+        populate_matrix(matA.get(), M, K);
+        populate_matrix(matB.get(), N, K);
+
+        double flops = 2.0 * M * N * K;
+        double sgemm_time = best_time([&]() {
+            sgemm('N', 'T', M, N, K, 1.0f, matA.get(), K, matB.get(), K, 0.0f,
+                  matC.get(), N);
+        });
+
+        for (MxElement element : {MxElement::Int8, MxElement::Fp8E4M3}) {
+            std::shared_ptr<const MxMatrix> mxA, mxB;
+            double encode_time = best_time([&]() {
+                mxB = mx_encode(element, N, K, matB.get(), K);
+            });
+            mxA = mx_encode(element, M, K, matA.get(), K);
+
+            double mixed_time = best_time([&]() {
+                sgemm_mx('N', 'T', M, 1.0f, matA.get(), K, *mxB, 0.0f,
+                         matX.get(), N);
+            });
+            if (!compare_matrices(matX.get(), matC.get(), M, N, TOLERANCE)) {
+                std::cout << "Mixed result is off the float reference"
+                          << std::endl;
+                return 1;
+            }
+
+            double mx_time = best_time([&]() {
+                sgemm_mx('N', 'T', 1.0f, *mxA, *mxB, 0.0f, matX.get(), N);
+            });
+
+            printf("%6d %6d %6d %8s %10.1f %10.1f %9.2fx %10.1f %9.2fx "
+                   "%10.2f\n",
+                   M, N, K, element == MxElement::Int8 ? "int8" : "fp8",
+                   flops / sgemm_time * 1e-9, flops / mx_time * 1e-9,
+                   sgemm_time / mx_time, flops / mixed_time * 1e-9,
+                   sgemm_time / mixed_time,
+                   (double)N * K * sizeof(float) / encode_time * 1e-9);
+
+            if (!compare_matrices(matX.get(), matC.get(), M, N, TOLERANCE)) {
+                std::cout << "MX result is off the float reference"
+                          << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
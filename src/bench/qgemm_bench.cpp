@@ -0,0 +1,96 @@
+#include <Host/HostGemm.hpp>
+#include <Host/QuantizedGemm.hpp>
+#include <Host/ThreadPool.hpp>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <stdio.h>
+#include <utils/util.hpp>
+
+// Compares the int8 GEMM (dequantized to float) against sgemm on the float
+// matrices it was quantized from, for accuracy and speed. A is quantized per
+// tensor and B per column; the packed column multiplies against B packed
+// once by int8_pack_b.
+
+#define REPEATS 5
+
+// Relative error allowed between the int8 and the float result
+#define TOLERANCE 0.05f
+
+struct Shape {
+    int M;
+    int N;
+    int K;
+};
+
+static const Shape SHAPES[] = {
+    {256, 256, 256}, {1000, 1000, 1000}, {64, 4096, 1024},
+    {2048, 512, 2048}, {1, 4096, 4096},
+};
+
+template <class Fn> static double best_gops(const Shape &shape, Fn fn) {
+    double best = 0.0;
+    for (int r = 0; r < REPEATS; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start;
+        best = std::max(best, 2.0 * shape.M * shape.N * shape.K /
+                                  elapsed.count() * 1e-9);
+    }
+    return best;
+}
+
+int main() {
+    printf("%d workers\n", ThreadPool::instance().size());
+    printf("%6s %6s %6s %12s %12s %12s %8s\n", "M", "N", "K", "sgemm GF/s",
+           "int8 GOP/s", "packed GOP/s", "speedup");
+
+    for (const Shape &shape : SHAPES) {
+        int M = shape.M, N = shape.N, K = shape.K;
+        auto matA = std::make_unique<float[]>((size_t)M * K);
+        auto matB = std::make_unique<float[]>((size_t)K * N);
+        auto matC = std::make_unique<float[]>((size_t)M * N);
+        auto matQ = std::make_unique<float[]>((size_t)M * N);
+        auto matP = std::make_unique<float[]>((size_t)M * N);
+        auto qA = std::make_unique<int8_t[]>((size_t)M * K);
+        auto qB = std::make_unique<int8_t[]>((size_t)K * N);
+        auto scalesB = std::make_unique<float[]>(N);
+
+        populate_matrix(matA.get(), M, K);
+        populate_matrix(matB.get(), K, N);
+
+        QuantizedGemmScales scales;
+        scales.a = quantize_tensor(M, K, matA.get(), K, qA.get(), K);
+        quantize_columns(K, N, matB.get(), N, qB.get(), N, scalesB.get());
+        scales.b = scalesB.get();
+        scales.perChannel = true;
+
+        double sgemm_gops = best_gops(shape, [&]() {
+            sgemm('N', 'N', M, N, K, 1.0f, matA.get(), K, matB.get(), N,
+                  0.0f, matC.get(), N);
+        });
+        double int8_gops = best_gops(shape, [&]() {
+            qgemm_dequantize('N', 'N', M, N, K, qA.get(), K, qB.get(), N,
+                             scales, nullptr, matQ.get(), N);
+        });
+
+        auto packedB = int8_pack_b('N', K, N, qB.get(), N);
+        double packed_gops = best_gops(shape, [&]() {
+            qgemm_dequantize('N', M, qA.get(), K, *packedB, scales, nullptr,
+                             matP.get(), N);
+        });
+
+        printf("%6d %6d %6d %12.1f %12.1f %12.1f %7.2fx\n", M, N, K,
+               sgemm_gops, int8_gops, packed_gops, packed_gops / sgemm_gops);
+
+        if (!compare_matrices(matQ.get(), matC.get(), M, N, TOLERANCE) ||
+            !compare_matrices(matP.get(), matQ.get(), M, N)) {
+            std::cout << "int8 result is off the float reference" << std::endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,104 @@
+#include <Host/HostGemm.hpp>
+#include <Host/ThreadPool.hpp>
+#include <Host/TypedGemm.hpp>
+#include <chrono>
+#include <complex>
+#include <iostream>
+#include <memory>
+#include <stdio.h>
+#include <utils/util.hpp>
+
+// Times host_matrix_multiply in every precision, and the Standard and 3M
+// methods of the complex products against each other. Rates are in real
+// GFLOPS of the standard algorithm (8 per complex multiply-add), so 3M shows
+// up as a higher rate for the same product.
+
+#define REPEATS 5
+
+// Relative difference allowed between the 3M and the Standard result
+#define TOLERANCE 1e-3
+
+struct Shape {
+    int M;
+    int N;
+    int K;
+};
+
+static const Shape SHAPES[] = {
+    {256, 256, 256}, {1000, 1000, 1000}, {517, 769, 1031}, {2048, 128, 2048},
+};
+
+template <class T> static double flops_per_fma() { return 2.0; }
+
+template <> double flops_per_fma<std::complex<float>>() { return 8.0; }
+
+template <> double flops_per_fma<std::complex<double>>() { return 8.0; }
+
+// Best of REPEATS runs, in GFLOPS
+template <class T>
+static double benchmark(const Shape &shape, const T *matA, const T *matB,
+                        T *matC) {
+    double best = 0.0;
+    for (int r = 0; r < REPEATS; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        host_matrix_multiply(matA, matB, matC, shape.M, shape.N, shape.K);
+        std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start;
+        best = std::max(best, flops_per_fma<T>() * shape.M * shape.N *
+                                  shape.K / elapsed.count() * 1e-9);
+    }
+    return best;
+}
+
+template <class T> static double run(const Shape &shape) {
+    auto matA = std::make_unique<T[]>((size_t)shape.M * shape.K);
+    auto matB = std::make_unique<T[]>((size_t)shape.K * shape.N);
+    auto matC = std::make_unique<T[]>((size_t)shape.M * shape.N);
+    populate_matrix(matA.get(), shape.M, shape.K);
+    populate_matrix(matB.get(), shape.K, shape.N);
+    return benchmark(shape, matA.get(), matB.get(), matC.get());
+}
+
+// Standard and 3M rates of one complex type; false when they disagree
+template <class T>
+static bool run_complex(const Shape &shape, double &standard, double &three_m) {
+    auto matA = std::make_unique<T[]>((size_t)shape.M * shape.K);
+    auto matB = std::make_unique<T[]>((size_t)shape.K * shape.N);
+    auto matC = std::make_unique<T[]>((size_t)shape.M * shape.N);
+    auto mat3 = std::make_unique<T[]>((size_t)shape.M * shape.N);
+    populate_matrix(matA.get(), shape.M, shape.K);
+    populate_matrix(matB.get(), shape.K, shape.N);
+
+    host_gemm_set_complex_method(ComplexGemmMethod::Standard);
+    standard = benchmark(shape, matA.get(), matB.get(), matC.get());
+    host_gemm_set_complex_method(ComplexGemmMethod::ThreeM);
+    three_m = benchmark(shape, matA.get(), matB.get(), mat3.get());
+    host_gemm_set_complex_method(ComplexGemmMethod::Standard);
+
+    return compare_matrices(mat3.get(), matC.get(), shape.M, shape.N,
+                            TOLERANCE);
+}
+
+int main() {
+    printf("%d workers\n", ThreadPool::instance().size());
+    printf("%6s %6s %6s %8s %8s %8s %8s %8s %8s\n", "M", "N", "K", "float",
+           "double", "c 4M", "c 3M", "z 4M", "z 3M");
+
+    for (const Shape &shape : SHAPES) {
+        double s = run<float>(shape);
+        double d = run<double>(shape);
+        double c4, c3, z4, z3;
+        bool c_ok = run_complex<std::complex<float>>(shape, c4, c3);
+        bool z_ok = run_complex<std::complex<double>>(shape, z4, z3);
+
+        printf("%6d %6d %6d %8.1f %8.1f %8.1f %8.1f %8.1f %8.1f\n", shape.M,
+               shape.N, shape.K, s, d, c4, c3, z4, z3);
+
+        if (!c_ok || !z_ok) {
+            std::cout << "3M result is off the standard one" << std::endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
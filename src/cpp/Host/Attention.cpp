@@ -0,0 +1,260 @@
+#include <Host/AlignedBuffer.hpp>
+#include <Host/Attention.hpp>
+#include <Host/GemmKernels.hpp>
+#include <Host/WorkStealingScheduler.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+// Query rows per task, rounded up to whole register tiles
+constexpr int ATTENTION_BLOCK_Q = 64;
+
+// Keys per step of the online softmax, rounded up to whole register tiles.
+// The score tile and the packed K and V blocks of one step stay in L2.
+constexpr int ATTENTION_BLOCK_K = 128;
+
+struct AttentionProblem {
+    int Lq;
+    int Lk;
+    int D;
+    int Dv;
+    const float *Q;
+    int ldq;
+    const float *K;
+    int ldk;
+    const float *V;
+    int ldv;
+    float *O;
+    int ldo;
+    float scale;
+    bool causal;
+};
+
+static int round_up(int value, int multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+static int ceil_div(int value, int divisor) {
+    return (value + divisor - 1) / divisor;
+}
+
+// exp(x) for x <= 0 without a library call, so that the softmax loop
+// vectorizes: 2^n times a degree 7 polynomial of the remainder (Cephes
+// expf), within a few ulp of std::exp. Inputs below -87 give 2^-126 instead
+// of a denormal or zero, which is negligible next to the row's largest term,
+// always exp(0) = 1.
+static inline float softmax_exp(float x) {
+    x = std::max(x, -87.0f);
+    // Round to nearest, valid since x * log2(e) <= 0
+    int n = (int)(x * 1.44269504f - 0.5f);
+    float r = x - (float)n * 0.693359375f + (float)n * 2.12194440e-4f;
+    float y = 1.9875691500e-4f;
+    y = y * r + 1.3981999507e-3f;
+    y = y * r + 8.3334519073e-3f;
+    y = y * r + 4.1665795894e-2f;
+    y = y * r + 1.6666665459e-1f;
+    y = y * r + 5.0000001201e-1f;
+    y = y * r * r + r + 1.0f;
+
+    uint32_t bits = (uint32_t)(n + 127) << 23;
+    float scale;
+    std::memcpy(&scale, &bits, sizeof(scale));
+    return y * scale;
+}
+
+// Attention for query rows [i0, i0 + rows) of one problem
+static void attention_block(const GemmKernel &kernel,
+                            const AttentionProblem &p, int i0, int rows) {
+    const int MR = kernel.blocking.mr;
+    const int NR = kernel.blocking.nr;
+    const float NEG_INF = -std::numeric_limits<float>::infinity();
+
+    // Query i sees keys j <= i + offset when the mask is on
+    const int offset = p.Lk - p.Lq;
+    int key_end = p.Lk;
+    if (p.causal) {
+        key_end = std::max(0, std::min(p.Lk, i0 + rows + offset));
+    }
+
+    int block_k = round_up(ATTENTION_BLOCK_K, NR);
+    int br = round_up(rows, MR);
+    int ld_s = round_up(std::min(block_k, std::max(1, key_end)), NR);
+    int ld_o = round_up(std::max(1, p.Dv), NR);
+
+    thread_local AlignedBuffer buffer_q;
+    thread_local AlignedBuffer buffer_k;
+    thread_local AlignedBuffer buffer_v;
+    thread_local AlignedBuffer buffer_s;
+    thread_local AlignedBuffer buffer_p;
+    thread_local AlignedBuffer buffer_o;
+    thread_local AlignedBuffer buffer_stats;
+
+    float *packed_q = buffer_q.reserve((size_t)br * std::max(1, p.D));
+    float *packed_k = buffer_k.reserve((size_t)std::max(1, p.D) * ld_s);
+    float *packed_v = buffer_v.reserve((size_t)ld_s * ld_o);
+    float *s = buffer_s.reserve((size_t)br * ld_s);
+    float *packed_p = buffer_p.reserve((size_t)br * ld_s);
+    float *o = buffer_o.reserve((size_t)br * ld_o);
+    float *row_max = buffer_stats.reserve(2 * (size_t)br);
+    float *row_sum = row_max + br;
+
+    std::fill(o, o + (size_t)br * ld_o, 0.0f);
+    std::fill(row_max, row_max + rows, NEG_INF);
+    std::fill(row_sum, row_sum + rows, 0.0f);
+
+    gemm_pack_a(MR, rows, p.D, p.Q + (size_t)i0 * p.ldq, p.ldq, 1, packed_q);
+
+    for (int j0 = 0; j0 < key_end; j0 += block_k) {
+        int bc = std::min(block_k, key_end - j0);
+
+        // S = scale * Q * K^T for this key block. K^T is read through swapped
+        // strides, and register tiles hidden by the mask are skipped.
+        gemm_pack_b(NR, p.D, bc, p.K + (size_t)j0 * p.ldk, 1, p.ldk,
+                    packed_k);
+        for (int jr = 0; jr < bc; jr += NR) {
+            for (int ir = 0; ir < rows; ir += MR) {
+                if (p.causal && j0 + jr > i0 + ir + MR - 1 + offset) {
+                    continue;
+                }
+                kernel.fn(p.D, packed_q + (size_t)ir * p.D,
+                          packed_k + (size_t)jr * p.D,
+                          s + (size_t)ir * ld_s + jr, ld_s, p.scale, 0.0f);
+            }
+        }
+
+        // Online softmax: fold the block into the running maximum and sum,
+        // turn S into the unnormalized probabilities P and rescale the rows
+        // of O computed so far to the new maximum
+        for (int i = 0; i < rows; ++i) {
+            float *srow = s + (size_t)i * ld_s;
+            int visible = bc;
+            if (p.causal) {
+                visible = std::max(0, std::min(bc, i0 + i + offset - j0 + 1));
+            }
+
+            float new_max = row_max[i];
+            for (int j = 0; j < visible; ++j) {
+                new_max = std::max(new_max, srow[j]);
+            }
+            if (new_max == NEG_INF) {
+                std::fill(srow, srow + bc, 0.0f);
+                continue;
+            }
+
+            for (int j = 0; j < visible; ++j) {
+                srow[j] = softmax_exp(srow[j] - new_max);
+            }
+            float sum = 0.0f;
+            for (int j = 0; j < visible; ++j) {
+                sum += srow[j];
+            }
+            std::fill(srow + visible, srow + bc, 0.0f);
+
+            float correction = std::exp(row_max[i] - new_max);
+            if (correction != 1.0f) {
+                float *orow = o + (size_t)i * ld_o;
+                for (int c = 0; c < p.Dv; ++c) {
+                    orow[c] *= correction;
+                }
+            }
+            row_sum[i] = row_sum[i] * correction + sum;
+            row_max[i] = new_max;
+        }
+
+        // O += P * V
+        gemm_pack_a(MR, rows, bc, s, ld_s, 1, packed_p);
+        gemm_pack_b(NR, bc, p.Dv, p.V + (size_t)j0 * p.ldv, p.ldv, 1,
+                    packed_v);
+        for (int jr = 0; jr < p.Dv; jr += NR) {
+            for (int ir = 0; ir < rows; ir += MR) {
+                kernel.fn(bc, packed_p + (size_t)ir * bc,
+                          packed_v + (size_t)jr * bc,
+                          o + (size_t)ir * ld_o + jr, ld_o, 1.0f, 1.0f);
+            }
+        }
+    }
+
+    for (int i = 0; i < rows; ++i) {
+        float inv = row_sum[i] > 0.0f ? 1.0f / row_sum[i] : 0.0f;
+        const float *orow = o + (size_t)i * ld_o;
+        float *dst = p.O + (size_t)(i0 + i) * p.ldo;
+        for (int c = 0; c < p.Dv; ++c) {
+            dst[c] = orow[c] * inv;
+        }
+    }
+}
+
+static void attention_driver(const AttentionProblem &first,
+                             ptrdiff_t strideQ, ptrdiff_t strideK,
+                             ptrdiff_t strideV, ptrdiff_t strideO,
+                             int batch) {
+    if (batch <= 0 || first.Lq <= 0 || first.Dv <= 0) {
+        return;
+    }
+
+    const GemmKernel &kernel = gemm_kernel();
+    int block_q = round_up(ATTENTION_BLOCK_Q, kernel.blocking.mr);
+    int blocks = ceil_div(first.Lq, block_q);
+
+    WorkStealingScheduler::instance().parallelFor(
+        batch * blocks, [&](int task, int) {
+            int member = task / blocks;
+            AttentionProblem p = first;
+            p.Q += member * strideQ;
+            p.K += member * strideK;
+            p.V += member * strideV;
+            p.O += member * strideO;
+
+            int i0 = (task % blocks) * block_q;
+            attention_block(kernel, p, i0, std::min(block_q, p.Lq - i0));
+        });
+}
+
+static AttentionProblem make_problem(int Lq, int Lk, int D, int Dv,
+                                     const float *Q, int ldq, const float *K,
+                                     int ldk, const float *V, int ldv,
+                                     float *O, int ldo, float scale,
+                                     bool causal) {
+    if (Lq < 0 || Lk < 0 || D < 0 || Dv < 0) {
+        throw std::invalid_argument("Matrix dimensions must not be negative");
+    }
+    if (ldq < std::max(1, D) || ldk < std::max(1, D) ||
+        ldv < std::max(1, Dv) || ldo < std::max(1, Dv)) {
+        throw std::invalid_argument(
+            "Leading dimension is smaller than the matrix row");
+    }
+    return {Lq, Lk, D, Dv, Q, ldq, K, ldk, V, ldv, O, ldo, scale, causal};
+}
+
+void host_attention(int Lq, int Lk, int D, int Dv, const float *Q, int ldq,
+                    const float *K, int ldk, const float *V, int ldv,
+                    float *O, int ldo, float scale, bool causal) {
+    attention_driver(make_problem(Lq, Lk, D, Dv, Q, ldq, K, ldk, V, ldv, O,
+                                  ldo, scale, causal),
+                     0, 0, 0, 0, 1);
+}
+
+void host_attention_batched(int Lq, int Lk, int D, int Dv, const float *Q,
+                            int ldq, ptrdiff_t strideQ, const float *K,
+                            int ldk, ptrdiff_t strideK, const float *V,
+                            int ldv, ptrdiff_t strideV, float *O, int ldo,
+                            ptrdiff_t strideO, float scale, bool causal,
+                            int batch) {
+    AttentionProblem first = make_problem(Lq, Lk, D, Dv, Q, ldq, K, ldk, V,
+                                          ldv, O, ldo, scale, causal);
+
+    if (batch < 0) {
+        throw std::invalid_argument("Batch count must not be negative");
+    }
+    if (batch > 1 && Lq > 0 && Dv > 0 &&
+        std::abs(strideO) < (ptrdiff_t)(Lq - 1) * ldo + Dv) {
+        throw std::invalid_argument(
+            "Batch stride of O makes the outputs overlap");
+    }
+
+    attention_driver(first, strideQ, strideK, strideV, strideO, batch);
+}
@@ -0,0 +1,66 @@
+#include <Host/CpuFeatures.hpp>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+
+static uint64_t read_xcr0() {
+    uint32_t eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return ((uint64_t)edx << 32) | eax;
+}
+
+static CpuFeatures detect_cpu_features() {
+    CpuFeatures features;
+    unsigned int eax, ebx, ecx, edx;
+
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        return features;
+    }
+
+    features.sse42 = ecx & (1u << 20);
+    bool osxsave = ecx & (1u << 27);
+    bool avx = ecx & (1u << 28);
+    bool fma = ecx & (1u << 12);
+    bool f16c = ecx & (1u << 29);
+
+    // XMM and YMM state must be enabled by the OS before AVX can be used,
+    // and additionally the opmask and upper ZMM state for AVX-512
+    uint64_t xcr0 = osxsave ? read_xcr0() : 0;
+    bool os_avx = (xcr0 & 0x6) == 0x6;
+    bool os_avx512 = os_avx && (xcr0 & 0xe0) == 0xe0;
+
+    features.avx = avx && os_avx;
+    features.fma = fma && os_avx;
+    features.f16c = f16c && os_avx;
+
+    if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+        features.avx2 = (ebx & (1u << 5)) && os_avx;
+        features.avx512f = (ebx & (1u << 16)) && os_avx512;
+        features.avx512vnni = (ecx & (1u << 11)) && features.avx512f;
+
+        // EAX of subleaf 0 is the highest subleaf; BF16 lives in subleaf 1
+        if (eax >= 1 && __get_cpuid_count(7, 1, &eax, &ebx, &ecx, &edx)) {
+            features.avx512bf16 = (eax & (1u << 5)) && features.avx512f;
+        }
+    }
+
+    return features;
+}
+
+#else
+
+static CpuFeatures detect_cpu_features() {
+    CpuFeatures features;
+#if defined(__aarch64__) || defined(__ARM_NEON)
+    features.neon = true;
+#endif
+    return features;
+}
+
+#endif
+
+const CpuFeatures &cpu_features() {
+    static const CpuFeatures features = detect_cpu_features();
+    return features;
+}
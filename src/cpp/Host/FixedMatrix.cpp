@@ -0,0 +1,55 @@
+#include <Host/FixedMatrix.hpp>
+
+typedef void (*FixedKernel)(float alpha, const float *A, int rsa, int csa,
+                            const float *B, int rsb, int csb, float beta,
+                            float *C, int ldc);
+
+template <int M, int N, int K>
+static void fixed_kernel(float alpha, const float *A, int rsa, int csa,
+                         const float *B, int rsb, int csb, float beta,
+                         float *C, int ldc) {
+    Matrix<M, N> c = Matrix<M, K>::load(A, rsa, csa) *
+                     Matrix<K, N>::load(B, rsb, csb);
+
+    if (beta == 0.0f) {
+        for (float &value : c.m) {
+            value *= alpha;
+        }
+    } else {
+        Matrix<M, N> old = Matrix<M, N>::load(C, ldc);
+        for (int i = 0; i < M * N; ++i) {
+            c.m[i] = alpha * c.m[i] + beta * old.m[i];
+        }
+    }
+    c.store(C, ldc);
+}
+
+// Every fixed_kernel instantiation, indexed as fn[M - 1][N - 1][K - 1]
+struct FixedKernelTable {
+    FixedKernel fn[FIXED_MATRIX_MAX_DIM][FIXED_MATRIX_MAX_DIM]
+                  [FIXED_MATRIX_MAX_DIM];
+};
+
+template <size_t... I>
+static constexpr FixedKernelTable
+make_fixed_kernels(std::index_sequence<I...>) {
+    constexpr int D = FIXED_MATRIX_MAX_DIM;
+    return {{fixed_kernel<I / (D * D) + 1, I / D % D + 1, I % D + 1>...}};
+}
+
+static constexpr FixedKernelTable FIXED_KERNELS = make_fixed_kernels(
+    std::make_index_sequence<FIXED_MATRIX_MAX_DIM * FIXED_MATRIX_MAX_DIM *
+                             FIXED_MATRIX_MAX_DIM>());
+
+bool fixed_matrix_multiply(int M, int N, int K, float alpha, const float *A,
+                           int rsa, int csa, const float *B, int rsb, int csb,
+                           float beta, float *C, int ldc) {
+    if (M < 1 || N < 1 || K < 1 || M > FIXED_MATRIX_MAX_DIM ||
+        N > FIXED_MATRIX_MAX_DIM || K > FIXED_MATRIX_MAX_DIM) {
+        return false;
+    }
+
+    FIXED_KERNELS.fn[M - 1][N - 1][K - 1](alpha, A, rsa, csa, B, rsb, csb,
+                                          beta, C, ldc);
+    return true;
+}
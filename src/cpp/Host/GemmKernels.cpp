@@ -0,0 +1,592 @@
+#include <Host/AlignedBuffer.hpp>
+#include <Host/CpuFeatures.hpp>
+#include <Host/GemmKernels.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <utility>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define GEMM_KERNELS_X86
+#include <immintrin.h>
+#elif defined(__aarch64__) || defined(__ARM_NEON)
+#define GEMM_KERNELS_NEON
+#include <arm_neon.h>
+#endif
+
+// Portable kernel, written so that the compiler can keep the accumulator tile
+// in registers and vectorize the inner loop for whatever the baseline ISA is.
+template <class T, int MR, int NR>
+static void gemm_ukernel_generic(int kc, const T *a, const T *b, T *c,
+                                 int ldc, T alpha, T beta) {
+    T acc[MR][NR] = {};
+
+    for (int p = 0; p < kc; ++p) {
+        for (int i = 0; i < MR; ++i) {
+            T ai = a[i];
+            for (int j = 0; j < NR; ++j) {
+                acc[i][j] += ai * b[j];
+            }
+        }
+        a += MR;
+        b += NR;
+    }
+
+    for (int i = 0; i < MR; ++i) {
+        T *row = c + (size_t)i * ldc;
+        if (beta == T(0)) {
+            for (int j = 0; j < NR; ++j) {
+                row[j] = alpha * acc[i][j];
+            }
+        } else {
+            for (int j = 0; j < NR; ++j) {
+                row[j] = alpha * acc[i][j] + beta * row[j];
+            }
+        }
+    }
+}
+
+#ifdef GEMM_KERNELS_X86
+
+// 4 x 8 tile in 8 xmm accumulators. SSE has no FMA, so this is mul + add.
+__attribute__((target("sse4.2"))) static void
+gemm_ukernel_sse42_4x8(int kc, const float *a, const float *b, float *c,
+                       int ldc, float alpha, float beta) {
+    __m128 acc[4][2];
+    for (int i = 0; i < 4; ++i) {
+        acc[i][0] = _mm_setzero_ps();
+        acc[i][1] = _mm_setzero_ps();
+    }
+
+    for (int p = 0; p < kc; ++p) {
+        __m128 b0 = _mm_load_ps(b);
+        __m128 b1 = _mm_load_ps(b + 4);
+        for (int i = 0; i < 4; ++i) {
+            __m128 ai = _mm_set1_ps(a[i]);
+            acc[i][0] = _mm_add_ps(acc[i][0], _mm_mul_ps(ai, b0));
+            acc[i][1] = _mm_add_ps(acc[i][1], _mm_mul_ps(ai, b1));
+        }
+        a += 4;
+        b += 8;
+    }
+
+    __m128 valpha = _mm_set1_ps(alpha);
+    __m128 vbeta = _mm_set1_ps(beta);
+    for (int i = 0; i < 4; ++i) {
+        float *row = c + (size_t)i * ldc;
+        for (int v = 0; v < 2; ++v) {
+            __m128 r = _mm_mul_ps(valpha, acc[i][v]);
+            if (beta != 0.0f) {
+                r = _mm_add_ps(r, _mm_mul_ps(vbeta, _mm_loadu_ps(row + 4 * v)));
+            }
+            _mm_storeu_ps(row + 4 * v, r);
+        }
+    }
+}
+
+// 6 x 16 tile in 12 ymm accumulators, leaving registers for two rows of B
+// and the broadcast element of A.
+__attribute__((target("avx2,fma"))) static void
+gemm_ukernel_avx2_6x16(int kc, const float *a, const float *b, float *c,
+                       int ldc, float alpha, float beta) {
+    __m256 acc[6][2];
+    for (int i = 0; i < 6; ++i) {
+        acc[i][0] = _mm256_setzero_ps();
+        acc[i][1] = _mm256_setzero_ps();
+    }
+
+    for (int p = 0; p < kc; ++p) {
+        __m256 b0 = _mm256_load_ps(b);
+        __m256 b1 = _mm256_load_ps(b + 8);
+        for (int i = 0; i < 6; ++i) {
+            __m256 ai = _mm256_broadcast_ss(a + i);
+            acc[i][0] = _mm256_fmadd_ps(ai, b0, acc[i][0]);
+            acc[i][1] = _mm256_fmadd_ps(ai, b1, acc[i][1]);
+        }
+        a += 6;
+        b += 16;
+    }
+
+    __m256 valpha = _mm256_set1_ps(alpha);
+    __m256 vbeta = _mm256_set1_ps(beta);
+    for (int i = 0; i < 6; ++i) {
+        float *row = c + (size_t)i * ldc;
+        for (int v = 0; v < 2; ++v) {
+            __m256 r = _mm256_mul_ps(valpha, acc[i][v]);
+            if (beta != 0.0f) {
+                r = _mm256_fmadd_ps(vbeta, _mm256_loadu_ps(row + 8 * v), r);
+            }
+            _mm256_storeu_ps(row + 8 * v, r);
+        }
+    }
+}
+
+// 14 x 32 tile in 28 zmm accumulators
+__attribute__((target("avx512f"))) static void
+gemm_ukernel_avx512_14x32(int kc, const float *a, const float *b, float *c,
+                          int ldc, float alpha, float beta) {
+    __m512 acc[14][2];
+    for (int i = 0; i < 14; ++i) {
+        acc[i][0] = _mm512_setzero_ps();
+        acc[i][1] = _mm512_setzero_ps();
+    }
+
+    for (int p = 0; p < kc; ++p) {
+        __m512 b0 = _mm512_load_ps(b);
+        __m512 b1 = _mm512_load_ps(b + 16);
+        for (int i = 0; i < 14; ++i) {
+            __m512 ai = _mm512_set1_ps(a[i]);
+            acc[i][0] = _mm512_fmadd_ps(ai, b0, acc[i][0]);
+            acc[i][1] = _mm512_fmadd_ps(ai, b1, acc[i][1]);
+        }
+        a += 14;
+        b += 32;
+    }
+
+    __m512 valpha = _mm512_set1_ps(alpha);
+    __m512 vbeta = _mm512_set1_ps(beta);
+    for (int i = 0; i < 14; ++i) {
+        float *row = c + (size_t)i * ldc;
+        for (int v = 0; v < 2; ++v) {
+            __m512 r = _mm512_mul_ps(valpha, acc[i][v]);
+            if (beta != 0.0f) {
+                r = _mm512_fmadd_ps(vbeta, _mm512_loadu_ps(row + 16 * v), r);
+            }
+            _mm512_storeu_ps(row + 16 * v, r);
+        }
+    }
+}
+
+// Double precision tiles keep the register budget of the float kernels:
+// half the lanes per register, so half the columns.
+
+// 4 x 4 tile in 8 xmm accumulators, mul + add
+__attribute__((target("sse4.2"))) static void
+dgemm_ukernel_sse42_4x4(int kc, const double *a, const double *b, double *c,
+                        int ldc, double alpha, double beta) {
+    __m128d acc[4][2];
+    for (int i = 0; i < 4; ++i) {
+        acc[i][0] = _mm_setzero_pd();
+        acc[i][1] = _mm_setzero_pd();
+    }
+
+    for (int p = 0; p < kc; ++p) {
+        __m128d b0 = _mm_load_pd(b);
+        __m128d b1 = _mm_load_pd(b + 2);
+        for (int i = 0; i < 4; ++i) {
+            __m128d ai = _mm_set1_pd(a[i]);
+            acc[i][0] = _mm_add_pd(acc[i][0], _mm_mul_pd(ai, b0));
+            acc[i][1] = _mm_add_pd(acc[i][1], _mm_mul_pd(ai, b1));
+        }
+        a += 4;
+        b += 4;
+    }
+
+    __m128d valpha = _mm_set1_pd(alpha);
+    __m128d vbeta = _mm_set1_pd(beta);
+    for (int i = 0; i < 4; ++i) {
+        double *row = c + (size_t)i * ldc;
+        for (int v = 0; v < 2; ++v) {
+            __m128d r = _mm_mul_pd(valpha, acc[i][v]);
+            if (beta != 0.0) {
+                r = _mm_add_pd(r, _mm_mul_pd(vbeta, _mm_loadu_pd(row + 2 * v)));
+            }
+            _mm_storeu_pd(row + 2 * v, r);
+        }
+    }
+}
+
+// 6 x 8 tile in 12 ymm accumulators
+__attribute__((target("avx2,fma"))) static void
+dgemm_ukernel_avx2_6x8(int kc, const double *a, const double *b, double *c,
+                       int ldc, double alpha, double beta) {
+    __m256d acc[6][2];
+    for (int i = 0; i < 6; ++i) {
+        acc[i][0] = _mm256_setzero_pd();
+        acc[i][1] = _mm256_setzero_pd();
+    }
+
+    for (int p = 0; p < kc; ++p) {
+        __m256d b0 = _mm256_load_pd(b);
+        __m256d b1 = _mm256_load_pd(b + 4);
+        for (int i = 0; i < 6; ++i) {
+            __m256d ai = _mm256_broadcast_sd(a + i);
+            acc[i][0] = _mm256_fmadd_pd(ai, b0, acc[i][0]);
+            acc[i][1] = _mm256_fmadd_pd(ai, b1, acc[i][1]);
+        }
+        a += 6;
+        b += 8;
+    }
+
+    __m256d valpha = _mm256_set1_pd(alpha);
+    __m256d vbeta = _mm256_set1_pd(beta);
+    for (int i = 0; i < 6; ++i) {
+        double *row = c + (size_t)i * ldc;
+        for (int v = 0; v < 2; ++v) {
+            __m256d r = _mm256_mul_pd(valpha, acc[i][v]);
+            if (beta != 0.0) {
+                r = _mm256_fmadd_pd(vbeta, _mm256_loadu_pd(row + 4 * v), r);
+            }
+            _mm256_storeu_pd(row + 4 * v, r);
+        }
+    }
+}
+
+// 14 x 16 tile in 28 zmm accumulators
+__attribute__((target("avx512f"))) static void
+dgemm_ukernel_avx512_14x16(int kc, const double *a, const double *b,
+                           double *c, int ldc, double alpha, double beta) {
+    __m512d acc[14][2];
+    for (int i = 0; i < 14; ++i) {
+        acc[i][0] = _mm512_setzero_pd();
+        acc[i][1] = _mm512_setzero_pd();
+    }
+
+    for (int p = 0; p < kc; ++p) {
+        __m512d b0 = _mm512_load_pd(b);
+        __m512d b1 = _mm512_load_pd(b + 8);
+        for (int i = 0; i < 14; ++i) {
+            __m512d ai = _mm512_set1_pd(a[i]);
+            acc[i][0] = _mm512_fmadd_pd(ai, b0, acc[i][0]);
+            acc[i][1] = _mm512_fmadd_pd(ai, b1, acc[i][1]);
+        }
+        a += 14;
+        b += 16;
+    }
+
+    __m512d valpha = _mm512_set1_pd(alpha);
+    __m512d vbeta = _mm512_set1_pd(beta);
+    for (int i = 0; i < 14; ++i) {
+        double *row = c + (size_t)i * ldc;
+        for (int v = 0; v < 2; ++v) {
+            __m512d r = _mm512_mul_pd(valpha, acc[i][v]);
+            if (beta != 0.0) {
+                r = _mm512_fmadd_pd(vbeta, _mm512_loadu_pd(row + 8 * v), r);
+            }
+            _mm512_storeu_pd(row + 8 * v, r);
+        }
+    }
+}
+
+#endif
+
+#ifdef GEMM_KERNELS_NEON
+
+// Row ROW of a tile += lane LANE of AV times the vectors of b. Lane
+// arguments of the laneq intrinsics must be constants, so rows are spelled
+// out rather than looped over.
+#define NEON_FMA_ROW_F32(ROW, AV, LANE)                                        \
+    do {                                                                       \
+        acc[ROW][0] = vfmaq_laneq_f32(acc[ROW][0], b0, AV, LANE);              \
+        acc[ROW][1] = vfmaq_laneq_f32(acc[ROW][1], b1, AV, LANE);              \
+        acc[ROW][2] = vfmaq_laneq_f32(acc[ROW][2], b2, AV, LANE);              \
+    } while (0)
+
+// 8 x 12 tile in 24 of the 32 q registers
+static void gemm_ukernel_neon_8x12(int kc, const float *a, const float *b,
+                                   float *c, int ldc, float alpha,
+                                   float beta) {
+    float32x4_t acc[8][3];
+    for (int i = 0; i < 8; ++i) {
+        for (int v = 0; v < 3; ++v) {
+            acc[i][v] = vdupq_n_f32(0.0f);
+        }
+    }
+
+    for (int p = 0; p < kc; ++p) {
+        float32x4_t b0 = vld1q_f32(b);
+        float32x4_t b1 = vld1q_f32(b + 4);
+        float32x4_t b2 = vld1q_f32(b + 8);
+        float32x4_t a0 = vld1q_f32(a);
+        float32x4_t a1 = vld1q_f32(a + 4);
+        NEON_FMA_ROW_F32(0, a0, 0);
+        NEON_FMA_ROW_F32(1, a0, 1);
+        NEON_FMA_ROW_F32(2, a0, 2);
+        NEON_FMA_ROW_F32(3, a0, 3);
+        NEON_FMA_ROW_F32(4, a1, 0);
+        NEON_FMA_ROW_F32(5, a1, 1);
+        NEON_FMA_ROW_F32(6, a1, 2);
+        NEON_FMA_ROW_F32(7, a1, 3);
+        a += 8;
+        b += 12;
+    }
+
+    for (int i = 0; i < 8; ++i) {
+        float *row = c + (size_t)i * ldc;
+        for (int v = 0; v < 3; ++v) {
+            float32x4_t r = vmulq_n_f32(acc[i][v], alpha);
+            if (beta != 0.0f) {
+                r = vfmaq_n_f32(r, vld1q_f32(row + 4 * v), beta);
+            }
+            vst1q_f32(row + 4 * v, r);
+        }
+    }
+}
+
+// NEON_FMA_ROW_F32 on two doubles per register
+#define NEON_FMA_ROW_F64(ROW, AV, LANE)                                        \
+    do {                                                                       \
+        acc[ROW][0] = vfmaq_laneq_f64(acc[ROW][0], b0, AV, LANE);              \
+        acc[ROW][1] = vfmaq_laneq_f64(acc[ROW][1], b1, AV, LANE);              \
+        acc[ROW][2] = vfmaq_laneq_f64(acc[ROW][2], b2, AV, LANE);              \
+    } while (0)
+
+// 8 x 6 tile in 24 of the 32 q registers, two doubles per register
+static void dgemm_ukernel_neon_8x6(int kc, const double *a, const double *b,
+                                   double *c, int ldc, double alpha,
+                                   double beta) {
+    float64x2_t acc[8][3];
+    for (int i = 0; i < 8; ++i) {
+        for (int v = 0; v < 3; ++v) {
+            acc[i][v] = vdupq_n_f64(0.0);
+        }
+    }
+
+    for (int p = 0; p < kc; ++p) {
+        float64x2_t b0 = vld1q_f64(b);
+        float64x2_t b1 = vld1q_f64(b + 2);
+        float64x2_t b2 = vld1q_f64(b + 4);
+        float64x2_t a0 = vld1q_f64(a);
+        float64x2_t a1 = vld1q_f64(a + 2);
+        float64x2_t a2 = vld1q_f64(a + 4);
+        float64x2_t a3 = vld1q_f64(a + 6);
+        NEON_FMA_ROW_F64(0, a0, 0);
+        NEON_FMA_ROW_F64(1, a0, 1);
+        NEON_FMA_ROW_F64(2, a1, 0);
+        NEON_FMA_ROW_F64(3, a1, 1);
+        NEON_FMA_ROW_F64(4, a2, 0);
+        NEON_FMA_ROW_F64(5, a2, 1);
+        NEON_FMA_ROW_F64(6, a3, 0);
+        NEON_FMA_ROW_F64(7, a3, 1);
+        a += 8;
+        b += 6;
+    }
+
+    for (int i = 0; i < 8; ++i) {
+        double *row = c + (size_t)i * ldc;
+        for (int v = 0; v < 3; ++v) {
+            float64x2_t r = vmulq_n_f64(acc[i][v], alpha);
+            if (beta != 0.0) {
+                r = vfmaq_n_f64(r, vld1q_f64(row + 2 * v), beta);
+            }
+            vst1q_f64(row + 2 * v, r);
+        }
+    }
+}
+
+#endif
+
+// Kernels in order of preference. Blocking is chosen so that an mc x kc block
+// of A fits comfortably in a 1-2 MB L2 and a kc x nr sliver of B in L1.
+static const GemmKernel GEMM_KERNELS[] = {
+#ifdef GEMM_KERNELS_X86
+    {"avx512", {14, 32, 168, 384, 4096}, gemm_ukernel_avx512_14x32},
+    {"avx2", {6, 16, 144, 256, 4096}, gemm_ukernel_avx2_6x16},
+    {"sse4.2", {4, 8, 128, 256, 4096}, gemm_ukernel_sse42_4x8},
+#endif
+#ifdef GEMM_KERNELS_NEON
+    {"neon", {8, 12, 128, 256, 4096}, gemm_ukernel_neon_8x12},
+#endif
+    {"generic", {8, 8, 128, 256, 4096}, gemm_ukernel_generic<float, 8, 8>},
+};
+
+// Double precision kernels under the same names. mc is halved against the
+// float kernels so that the packed A block takes the same bytes.
+static const DgemmKernel DGEMM_KERNELS[] = {
+#ifdef GEMM_KERNELS_X86
+    {"avx512", {14, 16, 84, 384, 2048}, dgemm_ukernel_avx512_14x16},
+    {"avx2", {6, 8, 72, 256, 2048}, dgemm_ukernel_avx2_6x8},
+    {"sse4.2", {4, 4, 64, 256, 2048}, dgemm_ukernel_sse42_4x4},
+#endif
+#ifdef GEMM_KERNELS_NEON
+    {"neon", {8, 6, 64, 256, 2048}, dgemm_ukernel_neon_8x6},
+#endif
+    {"generic", {4, 8, 64, 256, 2048}, gemm_ukernel_generic<double, 4, 8>},
+};
+
+template <class T>
+static void pack_a_panels(int MR, int mc, int kc, const T *a, ptrdiff_t rs,
+                          ptrdiff_t cs, T *dst) {
+    for (int ir = 0; ir < mc; ir += MR) {
+        int mr = std::min(MR, mc - ir);
+        const T *src = a + ir * rs;
+        for (int p = 0; p < kc; ++p) {
+            int i = 0;
+            for (; i < mr; ++i) {
+                dst[i] = src[i * rs + p * cs];
+            }
+            for (; i < MR; ++i) {
+                dst[i] = T(0);
+            }
+            dst += MR;
+        }
+    }
+}
+
+template <class T>
+static void pack_b_panels(int NR, int kc, int nc, const T *b, ptrdiff_t rs,
+                          ptrdiff_t cs, T *dst) {
+    for (int jr = 0; jr < nc; jr += NR) {
+        int nr = std::min(NR, nc - jr);
+        const T *src = b + jr * cs;
+        for (int p = 0; p < kc; ++p) {
+            const T *row = src + p * rs;
+            int j = 0;
+            if (cs == 1) {
+                for (; j < nr; ++j) {
+                    dst[j] = row[j];
+                }
+            } else {
+                for (; j < nr; ++j) {
+                    dst[j] = row[j * cs];
+                }
+            }
+            for (; j < NR; ++j) {
+                dst[j] = T(0);
+            }
+            dst += NR;
+        }
+    }
+}
+
+void gemm_pack_a(int MR, int mc, int kc, const float *a, ptrdiff_t rs,
+                 ptrdiff_t cs, float *dst) {
+    pack_a_panels(MR, mc, kc, a, rs, cs, dst);
+}
+
+void gemm_pack_b(int NR, int kc, int nc, const float *b, ptrdiff_t rs,
+                 ptrdiff_t cs, float *dst) {
+    pack_b_panels(NR, kc, nc, b, rs, cs, dst);
+}
+
+void gemm_pack_a(int MR, int mc, int kc, const double *a, ptrdiff_t rs,
+                 ptrdiff_t cs, double *dst) {
+    pack_a_panels(MR, mc, kc, a, rs, cs, dst);
+}
+
+void gemm_pack_b(int NR, int kc, int nc, const double *b, ptrdiff_t rs,
+                 ptrdiff_t cs, double *dst) {
+    pack_b_panels(NR, kc, nc, b, rs, cs, dst);
+}
+
+static inline float widen(float16 h) { return half_to_float(h); }
+
+static inline float widen(bfloat16 b) { return bfloat16_to_float(b); }
+
+// Widens a rows x cols block, element (i, j) at src[i * rs + j * cs], into
+// dst keeping its orientation: row-major when rows are contiguous,
+// column-major when columns are. Returns the strides of the widened block.
+template <class T>
+static std::pair<ptrdiff_t, ptrdiff_t> widen_block(int rows, int cols,
+                                                   const T *src, ptrdiff_t rs,
+                                                   ptrdiff_t cs, float *dst) {
+    if (cs == 1) {
+        for (int i = 0; i < rows; ++i) {
+            convert_to_float(src + i * rs, dst + (size_t)i * cols, cols);
+        }
+        return {cols, 1};
+    }
+    if (rs == 1) {
+        for (int j = 0; j < cols; ++j) {
+            convert_to_float(src + j * cs, dst + (size_t)j * rows, rows);
+        }
+        return {1, rows};
+    }
+    for (int i = 0; i < rows; ++i) {
+        for (int j = 0; j < cols; ++j) {
+            dst[(size_t)i * cols + j] = widen(src[i * rs + j * cs]);
+        }
+    }
+    return {cols, 1};
+}
+
+template <class T>
+static void pack_a_widened(int MR, int mc, int kc, const T *a, ptrdiff_t rs,
+                           ptrdiff_t cs, float *dst) {
+    thread_local AlignedBuffer buffer;
+    float *wide = buffer.reserve((size_t)mc * kc);
+    auto strides = widen_block(mc, kc, a, rs, cs, wide);
+    gemm_pack_a(MR, mc, kc, wide, strides.first, strides.second, dst);
+}
+
+template <class T>
+static void pack_b_widened(int NR, int kc, int nc, const T *b, ptrdiff_t rs,
+                           ptrdiff_t cs, float *dst) {
+    thread_local AlignedBuffer buffer;
+    float *wide = buffer.reserve((size_t)kc * nc);
+    auto strides = widen_block(kc, nc, b, rs, cs, wide);
+    gemm_pack_b(NR, kc, nc, wide, strides.first, strides.second, dst);
+}
+
+void gemm_pack_a(int MR, int mc, int kc, const float16 *a, ptrdiff_t rs,
+                 ptrdiff_t cs, float *dst) {
+    pack_a_widened(MR, mc, kc, a, rs, cs, dst);
+}
+
+void gemm_pack_a(int MR, int mc, int kc, const bfloat16 *a, ptrdiff_t rs,
+                 ptrdiff_t cs, float *dst) {
+    pack_a_widened(MR, mc, kc, a, rs, cs, dst);
+}
+
+void gemm_pack_b(int NR, int kc, int nc, const float16 *b, ptrdiff_t rs,
+                 ptrdiff_t cs, float *dst) {
+    pack_b_widened(NR, kc, nc, b, rs, cs, dst);
+}
+
+void gemm_pack_b(int NR, int kc, int nc, const bfloat16 *b, ptrdiff_t rs,
+                 ptrdiff_t cs, float *dst) {
+    pack_b_widened(NR, kc, nc, b, rs, cs, dst);
+}
+
+template <class Kernel> static bool kernel_supported(const Kernel &kernel) {
+    const CpuFeatures &cpu = cpu_features();
+
+    if (!std::strcmp(kernel.name, "avx512")) {
+        return cpu.avx512f;
+    }
+    if (!std::strcmp(kernel.name, "avx2")) {
+        return cpu.avx2 && cpu.fma;
+    }
+    if (!std::strcmp(kernel.name, "sse4.2")) {
+        return cpu.sse42;
+    }
+    if (!std::strcmp(kernel.name, "neon")) {
+        return cpu.neon;
+    }
+    return true;
+}
+
+template <class Kernel, size_t COUNT>
+static const Kernel &select_kernel(const Kernel (&kernels)[COUNT]) {
+    const char *forced = std::getenv("HOST_GEMM_KERNEL");
+
+    if (forced) {
+        for (const Kernel &kernel : kernels) {
+            if (!std::strcmp(kernel.name, forced) &&
+                kernel_supported(kernel)) {
+                return kernel;
+            }
+        }
+        std::cerr << "HOST_GEMM_KERNEL=" << forced
+                  << " is not available on this CPU, ignoring" << std::endl;
+    }
+
+    for (const Kernel &kernel : kernels) {
+        if (kernel_supported(kernel)) {
+            return kernel;
+        }
+    }
+    // The generic kernel is always supported
+    return kernels[COUNT - 1];
+}
+
+const GemmKernel &gemm_kernel() {
+    static const GemmKernel &kernel = select_kernel(GEMM_KERNELS);
+    return kernel;
+}
+
+const DgemmKernel &dgemm_kernel() {
+    static const DgemmKernel &kernel = select_kernel(DGEMM_KERNELS);
+    return kernel;
+}
@@ -0,0 +1,364 @@
+#include <Host/AlignedBuffer.hpp>
+#include <Host/CpuFeatures.hpp>
+#include <Host/Gemv.hpp>
+#include <Host/WorkStealingScheduler.hpp>
+#include <algorithm>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define GEMV_X86
+#endif
+
+// Multiply-adds below which a call stays on the calling thread
+constexpr double GEMV_PARALLEL_MIN_WORK = 1 << 17;
+
+// Row chunks handed to the scheduler, per worker and in rows
+constexpr int GEMV_TASKS_PER_WORKER = 4;
+constexpr int GEMV_ROW_ALIGN = 16;
+
+// Accumulator lanes of the dot product kernel. The lane loops compile to one
+// or a few vector operations for whatever width the target has.
+constexpr int GEMV_LANES = 16;
+
+template <class T> struct GemvKernels {
+    // out[i] = sum_k A[i * rs + k] * x[k] for i < rows
+    void (*dotRows)(int rows, int K, const T *A, ptrdiff_t rs, const T *x,
+                    T *out);
+    // acc[i] += sum_k x[k] * A[i + k * cs] for i < rows
+    void (*axpyColumns)(int rows, int K, const T *A, ptrdiff_t cs, const T *x,
+                        T *acc);
+    // C[i][j] = x[i * incx] * y[j] + beta * C[i][j]
+    void (*rank1Rows)(int rows, int N, const T *x, ptrdiff_t incx, const T *y,
+                      T beta, T *C, int ldc);
+};
+
+template <class T>
+static inline __attribute__((always_inline)) T lane_sum(const T *acc) {
+    T sum = 0;
+    for (int l = 0; l < GEMV_LANES; ++l) {
+        sum += acc[l];
+    }
+    return sum;
+}
+
+// Four rows share every load of x
+template <class T>
+static inline __attribute__((always_inline)) void
+dot_rows_body(int rows, int K, const T *A, ptrdiff_t rs, const T *x, T *out) {
+    int i = 0;
+    for (; i + 4 <= rows; i += 4) {
+        const T *a0 = A + i * rs;
+        const T *a1 = a0 + rs;
+        const T *a2 = a1 + rs;
+        const T *a3 = a2 + rs;
+        T acc0[GEMV_LANES] = {};
+        T acc1[GEMV_LANES] = {};
+        T acc2[GEMV_LANES] = {};
+        T acc3[GEMV_LANES] = {};
+
+        int k = 0;
+        for (; k + GEMV_LANES <= K; k += GEMV_LANES) {
+            for (int l = 0; l < GEMV_LANES; ++l) {
+                T xv = x[k + l];
+                acc0[l] += a0[k + l] * xv;
+                acc1[l] += a1[k + l] * xv;
+                acc2[l] += a2[k + l] * xv;
+                acc3[l] += a3[k + l] * xv;
+            }
+        }
+
+        T s0 = lane_sum(acc0);
+        T s1 = lane_sum(acc1);
+        T s2 = lane_sum(acc2);
+        T s3 = lane_sum(acc3);
+        for (; k < K; ++k) {
+            s0 += a0[k] * x[k];
+            s1 += a1[k] * x[k];
+            s2 += a2[k] * x[k];
+            s3 += a3[k] * x[k];
+        }
+        out[i] = s0;
+        out[i + 1] = s1;
+        out[i + 2] = s2;
+        out[i + 3] = s3;
+    }
+
+    for (; i < rows; ++i) {
+        const T *a = A + i * rs;
+        T acc[GEMV_LANES] = {};
+        int k = 0;
+        for (; k + GEMV_LANES <= K; k += GEMV_LANES) {
+            for (int l = 0; l < GEMV_LANES; ++l) {
+                acc[l] += a[k + l] * x[k + l];
+            }
+        }
+        T sum = lane_sum(acc);
+        for (; k < K; ++k) {
+            sum += a[k] * x[k];
+        }
+        out[i] = sum;
+    }
+}
+
+// Four columns per pass over the accumulators
+template <class T>
+static inline __attribute__((always_inline)) void
+axpy_columns_body(int rows, int K, const T *A, ptrdiff_t cs, const T *x,
+                  T *acc) {
+    int k = 0;
+    for (; k + 4 <= K; k += 4) {
+        const T *c0 = A + k * cs;
+        const T *c1 = c0 + cs;
+        const T *c2 = c1 + cs;
+        const T *c3 = c2 + cs;
+        T x0 = x[k], x1 = x[k + 1], x2 = x[k + 2], x3 = x[k + 3];
+        for (int i = 0; i < rows; ++i) {
+            acc[i] += x0 * c0[i] + x1 * c1[i] + x2 * c2[i] + x3 * c3[i];
+        }
+    }
+    for (; k < K; ++k) {
+        const T *c = A + k * cs;
+        T xk = x[k];
+        for (int i = 0; i < rows; ++i) {
+            acc[i] += xk * c[i];
+        }
+    }
+}
+
+template <class T>
+static inline __attribute__((always_inline)) void
+rank1_rows_body(int rows, int N, const T *x, ptrdiff_t incx, const T *y,
+                T beta, T *C, int ldc) {
+    for (int i = 0; i < rows; ++i) {
+        T xi = x[i * incx];
+        T *row = C + (size_t)i * ldc;
+        if (beta == T(0)) {
+            for (int j = 0; j < N; ++j) {
+                row[j] = xi * y[j];
+            }
+        } else {
+            for (int j = 0; j < N; ++j) {
+                row[j] = xi * y[j] + beta * row[j];
+            }
+        }
+    }
+}
+
+// Kernel bodies shared by every ISA; the variants only differ in the target
+// attribute they are compiled with. Every variant exists for float and
+// double, as overloads of the same name.
+#define GEMV_TYPED_KERNELS(SUFFIX, TARGET, T)                                  \
+    TARGET static void dot_rows_##SUFFIX(int rows, int K, const T *A,          \
+                                         ptrdiff_t rs, const T *x, T *out) {   \
+        dot_rows_body(rows, K, A, rs, x, out);                                 \
+    }                                                                          \
+                                                                               \
+    TARGET static void axpy_columns_##SUFFIX(int rows, int K, const T *A,      \
+                                             ptrdiff_t cs, const T *x,         \
+                                             T *acc) {                         \
+        axpy_columns_body(rows, K, A, cs, x, acc);                             \
+    }                                                                          \
+                                                                               \
+    TARGET static void rank1_rows_##SUFFIX(int rows, int N, const T *x,        \
+                                           ptrdiff_t incx, const T *y, T beta, \
+                                           T *C, int ldc) {                    \
+        rank1_rows_body(rows, N, x, incx, y, beta, C, ldc);                    \
+    }
+
+#define GEMV_KERNELS(SUFFIX, TARGET)                                           \
+    GEMV_TYPED_KERNELS(SUFFIX, TARGET, float)                                  \
+    GEMV_TYPED_KERNELS(SUFFIX, TARGET, double)
+
+GEMV_KERNELS(generic, )
+
+#ifdef GEMV_X86
+GEMV_KERNELS(avx2, __attribute__((target("avx2,fma"))))
+GEMV_KERNELS(avx512, __attribute__((target("avx512f"))))
+#endif
+
+template <class T> static const GemvKernels<T> &select_gemv_kernels() {
+    static const GemvKernels<T> generic = {
+        dot_rows_generic, axpy_columns_generic, rank1_rows_generic};
+#ifdef GEMV_X86
+    static const GemvKernels<T> avx2 = {dot_rows_avx2, axpy_columns_avx2,
+                                        rank1_rows_avx2};
+    static const GemvKernels<T> avx512 = {
+        dot_rows_avx512, axpy_columns_avx512, rank1_rows_avx512};
+
+    const CpuFeatures &cpu = cpu_features();
+    if (cpu.avx512f) {
+        return avx512;
+    }
+    if (cpu.avx2 && cpu.fma) {
+        return avx2;
+    }
+#endif
+    return generic;
+}
+
+template <class T> static const GemvKernels<T> &gemv_kernels() {
+    static const GemvKernels<T> &kernels = select_gemv_kernels<T>();
+    return kernels;
+}
+
+// Calls fn(i0, rows) for chunks of [0, M), spread over the thread pool when
+// the problem is large enough
+template <class Fn>
+static void for_row_chunks(int M, double work, const Fn &fn) {
+    WorkStealingScheduler &scheduler = WorkStealingScheduler::instance();
+
+    if (scheduler.size() == 1 || work < GEMV_PARALLEL_MIN_WORK ||
+        M <= GEMV_ROW_ALIGN) {
+        fn(0, M);
+        return;
+    }
+
+    int target = scheduler.size() * GEMV_TASKS_PER_WORKER;
+    int chunk = (M + target - 1) / target;
+    chunk = std::max(GEMV_ROW_ALIGN,
+                     (chunk + GEMV_ROW_ALIGN - 1) / GEMV_ROW_ALIGN *
+                         GEMV_ROW_ALIGN);
+    int tasks = (M + chunk - 1) / chunk;
+
+    scheduler.parallelFor(tasks, [&](int task, int) {
+        int i0 = task * chunk;
+        fn(i0, std::min(chunk, M - i0));
+    });
+}
+
+template <class T>
+void gemv_strided(int M, int N, T alpha, const T *A, ptrdiff_t rs,
+                  ptrdiff_t cs, const T *x, ptrdiff_t incx, T beta, T *y,
+                  ptrdiff_t incy) {
+    if (M <= 0) {
+        return;
+    }
+
+    if (N <= 0 || alpha == T(0)) {
+        for (int i = 0; i < M; ++i) {
+            T *yi = y + i * incy;
+            *yi = beta == T(0) ? T(0) : beta * *yi;
+        }
+        return;
+    }
+
+    const GemvKernels<T> &kernels = gemv_kernels<T>();
+
+    // The kernels read x contiguously; the gather belongs to the calling
+    // thread and is only read by the workers
+    thread_local AlignedBuffer buffer_x;
+    const T *xv = x;
+    if (incx != 1) {
+        T *gathered = buffer_x.reserve_as<T>(N);
+        for (int k = 0; k < N; ++k) {
+            gathered[k] = x[k * incx];
+        }
+        xv = gathered;
+    }
+
+    for_row_chunks(M, (double)M * N, [&](int i0, int rows) {
+        thread_local AlignedBuffer buffer_acc;
+        T *acc = buffer_acc.reserve_as<T>(rows);
+
+        if (cs == 1) {
+            kernels.dotRows(rows, N, A + i0 * rs, rs, xv, acc);
+        } else {
+            std::fill(acc, acc + rows, T(0));
+            if (rs == 1) {
+                kernels.axpyColumns(rows, N, A + i0, cs, xv, acc);
+            } else {
+                for (int i = 0; i < rows; ++i) {
+                    const T *a = A + (i0 + i) * rs;
+                    for (int k = 0; k < N; ++k) {
+                        acc[i] += a[k * cs] * xv[k];
+                    }
+                }
+            }
+        }
+
+        for (int i = 0; i < rows; ++i) {
+            T *yi = y + (i0 + i) * incy;
+            *yi = beta == T(0) ? alpha * acc[i] : alpha * acc[i] + beta * *yi;
+        }
+    });
+}
+
+template <class T>
+void rank1_strided(int M, int N, T alpha, const T *x, ptrdiff_t incx,
+                   const T *y, ptrdiff_t incy, T beta, T *C, int ldc) {
+    if (M <= 0 || N <= 0) {
+        return;
+    }
+
+    // alpha * y, contiguous, shared by every row
+    thread_local AlignedBuffer buffer_y;
+    T *ay = buffer_y.reserve_as<T>(N);
+    for (int j = 0; j < N; ++j) {
+        ay[j] = alpha * y[j * incy];
+    }
+
+    const GemvKernels<T> &kernels = gemv_kernels<T>();
+    for_row_chunks(M, (double)M * N, [&](int i0, int rows) {
+        kernels.rank1Rows(rows, N, x + i0 * incx, incx, ay, beta,
+                          C + (size_t)i0 * ldc, ldc);
+    });
+}
+
+#define GEMV_STRIDED(T)                                                        \
+    template void gemv_strided(int, int, T, const T *, ptrdiff_t, ptrdiff_t,   \
+                               const T *, ptrdiff_t, T, T *, ptrdiff_t);       \
+    template void rank1_strided(int, int, T, const T *, ptrdiff_t, const T *,  \
+                                ptrdiff_t, T, T *, int);
+
+GEMV_STRIDED(float)
+GEMV_STRIDED(double)
+
+static bool gemv_transposed(char trans) {
+    switch (trans) {
+    case 'N':
+    case 'n':
+        return false;
+    case 'T':
+    case 't':
+    case 'C':
+    case 'c':
+        return true;
+    default:
+        throw std::invalid_argument("Transpose flag must be 'N', 'T' or 'C'");
+    }
+}
+
+void sgemv(char trans, int M, int N, float alpha, const float *A, int lda,
+           const float *x, int incx, float beta, float *y, int incy) {
+    bool t = gemv_transposed(trans);
+
+    if (M < 0 || N < 0) {
+        throw std::invalid_argument("Matrix dimensions must not be negative");
+    }
+    if (lda < std::max(1, t ? M : N)) {
+        throw std::invalid_argument(
+            "Leading dimension is smaller than the matrix row");
+    }
+    if (incx < 1 || incy < 1) {
+        throw std::invalid_argument("Vector increments must be positive");
+    }
+
+    gemv_strided(M, N, alpha, A, t ? 1 : lda, t ? lda : 1, x, incx, beta, y,
+                 incy);
+}
+
+void sger(int M, int N, float alpha, const float *x, int incx, const float *y,
+          int incy, float *A, int lda) {
+    if (M < 0 || N < 0) {
+        throw std::invalid_argument("Matrix dimensions must not be negative");
+    }
+    if (lda < std::max(1, N)) {
+        throw std::invalid_argument(
+            "Leading dimension is smaller than the matrix row");
+    }
+    if (incx < 1 || incy < 1) {
+        throw std::invalid_argument("Vector increments must be positive");
+    }
+
+    rank1_strided(M, N, alpha, x, incx, y, incy, 1.0f, A, lda);
+}
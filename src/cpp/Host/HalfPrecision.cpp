@@ -0,0 +1,186 @@
+#include <Host/CpuFeatures.hpp>
+#include <Host/HalfPrecision.hpp>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define HALF_PRECISION_X86
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#define HALF_PRECISION_NEON
+#include <arm_neon.h>
+#endif
+
+typedef void (*HalfToFloat)(const float16 *src, float *dst, size_t count);
+typedef void (*FloatToHalf)(const float *src, float16 *dst, size_t count);
+typedef void (*BFloat16ToFloat)(const bfloat16 *src, float *dst,
+                                size_t count);
+typedef void (*FloatToBFloat16)(const float *src, bfloat16 *dst,
+                                size_t count);
+
+// Scalar loops. The bfloat16 ones are plain integer arithmetic that the
+// compiler vectorizes by itself, so they double as the vector versions when
+// cloned for a wider target.
+static inline __attribute__((always_inline)) void
+bfloat16_to_float_body(const bfloat16 *src, float *dst, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        dst[i] = bfloat16_to_float(src[i]);
+    }
+}
+
+static inline __attribute__((always_inline)) void
+float_to_bfloat16_body(const float *src, bfloat16 *dst, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        dst[i] = float_to_bfloat16(src[i]);
+    }
+}
+
+static void half_to_float_generic(const float16 *src, float *dst,
+                                  size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        dst[i] = half_to_float(src[i]);
+    }
+}
+
+static void float_to_half_generic(const float *src, float16 *dst,
+                                  size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        dst[i] = float_to_half(src[i]);
+    }
+}
+
+static void bfloat16_to_float_generic(const bfloat16 *src, float *dst,
+                                      size_t count) {
+    bfloat16_to_float_body(src, dst, count);
+}
+
+static void float_to_bfloat16_generic(const float *src, bfloat16 *dst,
+                                      size_t count) {
+    float_to_bfloat16_body(src, dst, count);
+}
+
+#ifdef HALF_PRECISION_X86
+
+__attribute__((target("avx,f16c"))) static void
+half_to_float_f16c(const float16 *src, float *dst, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i h = _mm_loadu_si128((const __m128i *)(src + i));
+        _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(h));
+    }
+    for (; i < count; ++i) {
+        dst[i] = half_to_float(src[i]);
+    }
+}
+
+__attribute__((target("avx,f16c"))) static void
+float_to_half_f16c(const float *src, float16 *dst, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(src + i),
+                                    _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128((__m128i *)(dst + i), h);
+    }
+    for (; i < count; ++i) {
+        dst[i] = float_to_half(src[i]);
+    }
+}
+
+__attribute__((target("avx2"))) static void
+bfloat16_to_float_avx2(const bfloat16 *src, float *dst, size_t count) {
+    bfloat16_to_float_body(src, dst, count);
+}
+
+__attribute__((target("avx2"))) static void
+float_to_bfloat16_avx2(const float *src, bfloat16 *dst, size_t count) {
+    float_to_bfloat16_body(src, dst, count);
+}
+
+__attribute__((target("avx512f,avx512bf16"))) static void
+float_to_bfloat16_avx512bf16(const float *src, bfloat16 *dst, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256bh b = _mm512_cvtneps_pbh(_mm512_loadu_ps(src + i));
+        _mm256_storeu_si256((__m256i *)(dst + i), (__m256i)b);
+    }
+    for (; i < count; ++i) {
+        dst[i] = float_to_bfloat16(src[i]);
+    }
+}
+
+#endif
+
+#ifdef HALF_PRECISION_NEON
+
+static void half_to_float_neon(const float16 *src, float *dst, size_t count) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        float16x4_t h =
+            vreinterpret_f16_u16(vld1_u16((const uint16_t *)(src + i)));
+        vst1q_f32(dst + i, vcvt_f32_f16(h));
+    }
+    for (; i < count; ++i) {
+        dst[i] = half_to_float(src[i]);
+    }
+}
+
+static void float_to_half_neon(const float *src, float16 *dst, size_t count) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        float16x4_t h = vcvt_f16_f32(vld1q_f32(src + i));
+        vst1_u16((uint16_t *)(dst + i), vreinterpret_u16_f16(h));
+    }
+    for (; i < count; ++i) {
+        dst[i] = float_to_half(src[i]);
+    }
+}
+
+#endif
+
+struct HalfConverters {
+    HalfToFloat halfToFloat = half_to_float_generic;
+    FloatToHalf floatToHalf = float_to_half_generic;
+    BFloat16ToFloat bfloat16ToFloat = bfloat16_to_float_generic;
+    FloatToBFloat16 floatToBFloat16 = float_to_bfloat16_generic;
+};
+
+static HalfConverters select_half_converters() {
+    HalfConverters converters;
+#ifdef HALF_PRECISION_X86
+    const CpuFeatures &cpu = cpu_features();
+    if (cpu.f16c) {
+        converters.halfToFloat = half_to_float_f16c;
+        converters.floatToHalf = float_to_half_f16c;
+    }
+    if (cpu.avx2) {
+        converters.bfloat16ToFloat = bfloat16_to_float_avx2;
+        converters.floatToBFloat16 = float_to_bfloat16_avx2;
+    }
+    if (cpu.avx512bf16) {
+        converters.floatToBFloat16 = float_to_bfloat16_avx512bf16;
+    }
+#elif defined(HALF_PRECISION_NEON)
+    converters.halfToFloat = half_to_float_neon;
+    converters.floatToHalf = float_to_half_neon;
+#endif
+    return converters;
+}
+
+static const HalfConverters &half_converters() {
+    static const HalfConverters converters = select_half_converters();
+    return converters;
+}
+
+void convert_to_float(const float16 *src, float *dst, size_t count) {
+    half_converters().halfToFloat(src, dst, count);
+}
+
+void convert_to_float(const bfloat16 *src, float *dst, size_t count) {
+    half_converters().bfloat16ToFloat(src, dst, count);
+}
+
+void convert_from_float(const float *src, float16 *dst, size_t count) {
+    half_converters().floatToHalf(src, dst, count);
+}
+
+void convert_from_float(const float *src, bfloat16 *dst, size_t count) {
+    half_converters().floatToBFloat16(src, dst, count);
+}
@@ -0,0 +1,1955 @@
+#include <Host/AlignedBuffer.hpp>
+#include <Host/CpuFeatures.hpp>
+#include <Host/FixedMatrix.hpp>
+#include <Host/GemmEngine.hpp>
+#include <Host/GemmKernels.hpp>
+#include <Host/Gemv.hpp>
+#include <Host/HostGemm.hpp>
+#include <Host/Microscaling.hpp>
+#include <Host/ThreadPool.hpp>
+#include <Host/WorkStealingScheduler.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define HOST_GEMM_X86
+#endif
+
+namespace {
+
+constexpr size_t PACK_ALIGNMENT = AlignedBuffer::ALIGNMENT;
+
+} // namespace
+
+// B operand packed once by sgemm_pack_b. Each kc deep block of rows is
+// stored as the nr wide column panels gemm_pack_b would produce for the full
+// width, so any nr aligned column range of a block is one contiguous run of
+// panels and tiles can use it in place of packing.
+class PackedMatrixB {
+  public:
+    int K;
+    int N;
+    int n_pad; // N rounded up to whole panels
+    GemmBlocking blocking;
+    AlignedBuffer storage;
+
+    // Packed panels starting at (row, col). row must be a multiple of kc and
+    // col a multiple of nr.
+    const float *panels(int row, int col) const {
+        int kc = std::min(blocking.kc, K - row);
+        return storage.data() + (size_t)row * n_pad + (size_t)col * kc;
+    }
+};
+
+// Columns per nibble block of an Int4MatrixB
+constexpr int INT4_BLOCK = 64;
+
+// B operand quantized by int4_pack_b. Row k of the K x N matrix of 4-bit
+// values takes row_bytes bytes in blocks of INT4_BLOCK columns: byte t of a
+// block holds column t in its low nibble and column t + INT4_BLOCK / 2 in
+// its high one, so either half of a block unpacks as one contiguous run.
+// Rows k of group k / group_size share a scale and zero point per column,
+// stored at group * N + j.
+class Int4MatrixB {
+  public:
+    int K;
+    int N;
+    int group_size;
+    int row_bytes;
+    std::vector<uint8_t> nibbles;
+    std::vector<float> scales;
+    std::vector<uint8_t> zeros;
+
+    static size_t byte_of(int j) {
+        return (size_t)(j / INT4_BLOCK) * (INT4_BLOCK / 2) +
+               j % (INT4_BLOCK / 2);
+    }
+
+    static int shift_of(int j) {
+        return j % INT4_BLOCK < INT4_BLOCK / 2 ? 0 : 4;
+    }
+
+    int nibble(int k, int j) const {
+        uint8_t byte = nibbles[(size_t)k * row_bytes + byte_of(j)];
+        return (byte >> shift_of(j)) & 15;
+    }
+};
+
+namespace {
+
+// Element type of an operand. Anything but Float32 is widened to float while
+// it is packed, so the micro-kernels and everything after them only see
+// floats.
+enum class GemmStorage { Float32, Float16, BFloat16, Int4, Mx };
+
+// True for the complex element types
+template <class T> struct is_complex_element : std::false_type {};
+
+template <class R>
+struct is_complex_element<std::complex<R>> : std::true_type {};
+
+// Strided view of a row-major operand with elements of type T. Element
+// (i, j) lives at data[i * rs + j * cs], which lets the packing routines
+// absorb transposes. A B operand may instead refer to pre-packed panels,
+// starting at element (row0, col0) of the packed matrix. Operands in a
+// 16-bit storage are held in source and addressed through (row0, col0) the
+// same way, as is an Int4MatrixB in source for a B in Int4 storage and an
+// MxMatrix for Mx storage. An MxMatrix holds the operand itself or, when
+// transposed is set, its transpose. Only float operands use anything but
+// plain strided storage; conj marks a conjugated complex operand.
+template <class T> struct GemmOperandOf {
+    const T *data;
+    int rs;
+    int cs;
+    const PackedMatrixB *packed = nullptr;
+    int row0 = 0;
+    int col0 = 0;
+    GemmStorage storage = GemmStorage::Float32;
+    const void *source = nullptr;
+    bool transposed = false;
+    bool conj = false;
+};
+
+typedef GemmOperandOf<float> GemmOperand;
+
+// True for operands that are plain strided elements at data
+template <class T> bool is_plain(const GemmOperandOf<T> &op) {
+    return !op.packed && op.storage == GemmStorage::Float32;
+}
+
+// View of op starting at its element (i, j)
+template <class T>
+GemmOperandOf<T> operand_at(const GemmOperandOf<T> &op, int i, int j) {
+    GemmOperandOf<T> view = op;
+    if (!is_plain(op)) {
+        view.row0 += i;
+        view.col0 += j;
+    } else {
+        view.data += (ptrdiff_t)i * op.rs + (ptrdiff_t)j * op.cs;
+    }
+    return view;
+}
+
+template <class T> bool has_epilogue(const GemmEpilogueOf<T> &ep) {
+    return ep.scale || ep.bias || ep.residual ||
+           ep.activation != GemmActivation::None;
+}
+
+// View of an epilogue for the block of C starting at element (i, j)
+template <class T>
+GemmEpilogueOf<T> epilogue_at(const GemmEpilogueOf<T> &ep, int i, int j) {
+    GemmEpilogueOf<T> view = ep;
+    if (ep.scale) {
+        view.scale += j;
+    }
+    if (ep.bias) {
+        view.bias += j;
+    }
+    if (ep.residual) {
+        view.residual += (size_t)i * ep.ldr + j;
+    }
+    return view;
+}
+
+// Runs the activation of an epilogue over a row of n values
+template <class T> void activate_row(GemmActivation activation, int n, T *row) {
+    switch (activation) {
+    case GemmActivation::None:
+        break;
+    case GemmActivation::ReLU:
+        for (int j = 0; j < n; ++j) {
+            row[j] = std::max(row[j], T(0));
+        }
+        break;
+    case GemmActivation::GELU:
+        for (int j = 0; j < n; ++j) {
+            row[j] = gemm_activate(GemmActivation::GELU, row[j]);
+        }
+        break;
+    }
+}
+
+// check_epilogue rejects activations on complex elements
+template <class R>
+void activate_row(GemmActivation, int, std::complex<R> *) {}
+
+// Applies the epilogue to an m x n block of C, one stage per loop so that
+// each loop vectorizes on its own
+template <class T>
+void apply_epilogue(const GemmEpilogueOf<T> &ep, int m, int n, T *C,
+                    int ldc) {
+    for (int i = 0; i < m; ++i) {
+        T *row = C + (size_t)i * ldc;
+        if (ep.scale) {
+            for (int j = 0; j < n; ++j) {
+                row[j] *= ep.scale[j];
+            }
+        }
+        if (ep.bias) {
+            for (int j = 0; j < n; ++j) {
+                row[j] += ep.bias[j];
+            }
+        }
+        activate_row(ep.activation, n, row);
+        if (ep.residual) {
+            const T *res = ep.residual + (size_t)i * ep.ldr;
+            for (int j = 0; j < n; ++j) {
+                row[j] += res[j];
+            }
+        }
+    }
+}
+
+// Multiplies a packed mc x kc block of A with a packed kc x nc panel of B into
+// the matching mc x nc block of C. Edge tiles are computed into a scratch tile
+// and only the valid part is merged into C. A non-null epilogue (offset to
+// this block) is applied to each tile straight after it is stored.
+template <class R>
+void macro_kernel(const GemmKernelOf<R> &kernel, int mc, int nc, int kc,
+                  const R *packed_a, const R *packed_b, R *c, int ldc,
+                  R alpha, R beta, const GemmEpilogueOf<R> *epilogue) {
+    const int MR = kernel.blocking.mr;
+    const int NR = kernel.blocking.nr;
+    alignas(PACK_ALIGNMENT) R edge[GEMM_MAX_TILE];
+
+    for (int jr = 0; jr < nc; jr += NR) {
+        int nr = std::min(NR, nc - jr);
+        const R *b = packed_b + (size_t)jr * kc;
+
+        for (int ir = 0; ir < mc; ir += MR) {
+            int mr = std::min(MR, mc - ir);
+            const R *a = packed_a + (size_t)ir * kc;
+            R *ctile = c + (size_t)ir * ldc + jr;
+
+            if (mr == MR && nr == NR) {
+                kernel.fn(kc, a, b, ctile, ldc, alpha, beta);
+            } else {
+                kernel.fn(kc, a, b, edge, NR, R(1), R(0));
+                for (int i = 0; i < mr; ++i) {
+                    R *row = ctile + (size_t)i * ldc;
+                    const R *src = edge + i * NR;
+                    if (beta == R(0)) {
+                        for (int j = 0; j < nr; ++j) {
+                            row[j] = alpha * src[j];
+                        }
+                    } else {
+                        for (int j = 0; j < nr; ++j) {
+                            row[j] = alpha * src[j] + beta * row[j];
+                        }
+                    }
+                }
+            }
+
+            if (epilogue) {
+                apply_epilogue(epilogue_at(*epilogue, ir, jr), mr, nr, ctile,
+                               ldc);
+            }
+        }
+    }
+}
+
+// Problems below this many multiply-adds are not worth waking the pool for
+constexpr double GEMM_PARALLEL_MIN_WORK = 64.0 * 64.0 * 64.0;
+
+// Tiles per worker handed to the work-stealing scheduler. A few tiles per
+// worker give the scheduler room to even out ragged edge tiles.
+constexpr int GEMM_TILES_PER_WORKER = 4;
+
+// Scale and offset (-zero * scale) of columns [col, col + n) in the group
+// of row k, which turn dequantization into one multiply-add per value
+void int4_group_terms(const Int4MatrixB &w, int k, int col, int n,
+                      float *scale, float *offset) {
+    size_t group = (size_t)(k / w.group_size) * w.N + col;
+    for (int j = 0; j < n; ++j) {
+        scale[j] = w.scales[group + j];
+        offset[j] = -(float)w.zeros[group + j] * scale[j];
+    }
+}
+
+// Dequantizes n values of row k of w, starting at column col, into dst
+// with the terms of int4_group_terms for the same columns. Whole nibble
+// blocks take two contiguous, vectorizable passes; columns before and after
+// them are unpacked one at a time.
+inline __attribute__((always_inline)) void
+dequantize_int4_row(const Int4MatrixB &w, int k, int col, int n,
+                    const float *__restrict scale,
+                    const float *__restrict offset, float *__restrict dst) {
+    const uint8_t *row = w.nibbles.data() + (size_t)k * w.row_bytes;
+    constexpr int HALF = INT4_BLOCK / 2;
+
+    int j = 0;
+    for (; j < n && (col + j) % INT4_BLOCK; ++j) {
+        dst[j] = (float)w.nibble(k, col + j) * scale[j] + offset[j];
+    }
+    for (; j + INT4_BLOCK <= n; j += INT4_BLOCK) {
+        const uint8_t *bytes = row + Int4MatrixB::byte_of(col + j);
+        for (int t = 0; t < HALF; ++t) {
+            dst[j + t] = (float)(bytes[t] & 15) * scale[j + t] + offset[j + t];
+        }
+        for (int t = 0; t < HALF; ++t) {
+            int c = j + HALF + t;
+            dst[c] = (float)(bytes[t] >> 4) * scale[c] + offset[c];
+        }
+    }
+    for (; j < n; ++j) {
+        dst[j] = (float)w.nibble(k, col + j) * scale[j] + offset[j];
+    }
+}
+
+// Dequantizes the kc x nc block of w at (row0, col0) into the panel layout
+// of gemm_pack_b, a row of the block at a time
+void pack_int4_b(int NR, int kc, int nc, const Int4MatrixB &w, int row0,
+                 int col0, float *dst) {
+    thread_local AlignedBuffer buffer;
+    float *row = buffer.reserve((size_t)3 * nc);
+    float *scale = row + nc;
+    float *offset = scale + nc;
+
+    for (int p = 0; p < kc; ++p) {
+        int k = row0 + p;
+        if (p == 0 || k % w.group_size == 0) {
+            int4_group_terms(w, k, col0, nc, scale, offset);
+        }
+        dequantize_int4_row(w, k, col0, nc, scale, offset, row);
+        for (int jr = 0; jr < nc; jr += NR) {
+            int nr = std::min(NR, nc - jr);
+            float *panel = dst + (size_t)jr * kc + (size_t)p * NR;
+            std::copy(row + jr, row + jr + nr, panel);
+            std::fill(panel + nr, panel + NR, 0.0f);
+        }
+    }
+}
+
+// Decodes an n lanes by kc deep block of an operand in Mx storage straight
+// into panels of W lanes, the layout of gemm_pack_a for lanes along the rows
+// of A and of gemm_pack_b for lanes along the columns of B. The block starts
+// at lane lane0 and depth depth0 of the operand. Rows of the MxMatrix run
+// along the depth when by_lane is set, and across the lanes otherwise; each
+// is decoded into a single run of scratch and stored from there, as
+// pack_int4_b does.
+void pack_mx_panels(int W, int n, int kc, const MxMatrix &mx, bool by_lane,
+                    int lane0, int depth0, float *dst) {
+    thread_local AlignedBuffer buffer;
+
+    if (!by_lane) {
+        float *run = buffer.reserve(n);
+        for (int p = 0; p < kc; ++p) {
+            mx_decode_row(mx, depth0 + p, lane0, n, run);
+            for (int x = 0; x < n; x += W) {
+                int w = std::min(W, n - x);
+                float *panel = dst + (size_t)x * kc + (size_t)p * W;
+                std::copy(run + x, run + x + w, panel);
+                std::fill(panel + w, panel + W, 0.0f);
+            }
+        }
+        return;
+    }
+
+    float *run = buffer.reserve(kc);
+    int lanes = (n + W - 1) / W * W;
+    for (int x = 0; x < lanes; ++x) {
+        float *lane = dst + (size_t)(x / W) * W * kc + x % W;
+        if (x < n) {
+            mx_decode_row(mx, lane0 + x, depth0, kc, run);
+        } else {
+            std::fill(run, run + kc, 0.0f); // Padding lanes of the last panel
+        }
+        for (int p = 0; p < kc; ++p) {
+            lane[(size_t)p * W] = run[p];
+        }
+    }
+}
+
+// Packs the mc x kc block of A starting at op, widening it if need be
+void pack_operand_a(int MR, int mc, int kc, const GemmOperand &op,
+                    float *dst) {
+    ptrdiff_t offset = (ptrdiff_t)op.row0 * op.rs + (ptrdiff_t)op.col0 * op.cs;
+    if (op.storage == GemmStorage::Mx) {
+        // Rows of an MxMatrix holding A itself are rows of A
+        const MxMatrix &mx = *static_cast<const MxMatrix *>(op.source);
+        pack_mx_panels(MR, mc, kc, mx, !op.transposed, op.row0, op.col0, dst);
+    } else if (op.storage == GemmStorage::Float16) {
+        const float16 *src = static_cast<const float16 *>(op.source);
+        gemm_pack_a(MR, mc, kc, src + offset, op.rs, op.cs, dst);
+    } else if (op.storage == GemmStorage::BFloat16) {
+        const bfloat16 *src = static_cast<const bfloat16 *>(op.source);
+        gemm_pack_a(MR, mc, kc, src + offset, op.rs, op.cs, dst);
+    } else {
+        gemm_pack_a(MR, mc, kc, op.data, op.rs, op.cs, dst);
+    }
+}
+
+// Packs the kc x nc panel of B starting at op, widening or dequantizing it
+// if need be
+void pack_operand_b(int NR, int kc, int nc, const GemmOperand &op,
+                    float *dst) {
+    ptrdiff_t offset = (ptrdiff_t)op.row0 * op.rs + (ptrdiff_t)op.col0 * op.cs;
+    if (op.storage == GemmStorage::Int4) {
+        const Int4MatrixB &w = *static_cast<const Int4MatrixB *>(op.source);
+        pack_int4_b(NR, kc, nc, w, op.row0, op.col0, dst);
+    } else if (op.storage == GemmStorage::Mx) {
+        // Rows of an MxMatrix holding B^T are columns of B
+        const MxMatrix &mx = *static_cast<const MxMatrix *>(op.source);
+        pack_mx_panels(NR, nc, kc, mx, op.transposed, op.col0, op.row0, dst);
+    } else if (op.storage == GemmStorage::Float16) {
+        const float16 *src = static_cast<const float16 *>(op.source);
+        gemm_pack_b(NR, kc, nc, src + offset, op.rs, op.cs, dst);
+    } else if (op.storage == GemmStorage::BFloat16) {
+        const bfloat16 *src = static_cast<const bfloat16 *>(op.source);
+        gemm_pack_b(NR, kc, nc, src + offset, op.rs, op.cs, dst);
+    } else {
+        gemm_pack_b(NR, kc, nc, op.data, op.rs, op.cs, dst);
+    }
+}
+
+// Operands of the other real types are always plain strided ones
+template <class R>
+void pack_operand_a(int MR, int mc, int kc, const GemmOperandOf<R> &op,
+                    R *dst) {
+    gemm_pack_a(MR, mc, kc, op.data, op.rs, op.cs, dst);
+}
+
+template <class R>
+void pack_operand_b(int NR, int kc, int nc, const GemmOperandOf<R> &op,
+                    R *dst) {
+    gemm_pack_b(NR, kc, nc, op.data, op.rs, op.cs, dst);
+}
+
+// Panels of a pre-packed B starting at its element (row, col); only float
+// B operands are ever pre-packed
+const float *packed_panels(const GemmOperand &b, int row, int col) {
+    return b.packed->panels(b.row0 + row, b.col0 + col);
+}
+
+template <class R>
+const R *packed_panels(const GemmOperandOf<R> &, int, int) {
+    return nullptr;
+}
+
+// Runs a block on its Matrix<M, K> specialization if there is one; those
+// only exist for float
+bool fixed_block(int M, int N, int K, float alpha, const GemmOperand &a,
+                 const GemmOperand &b, float beta, float *C, int ldc) {
+    return is_plain(a) && is_plain(b) &&
+           fixed_matrix_multiply(M, N, K, alpha, a.data, a.rs, a.cs, b.data,
+                                 b.rs, b.cs, beta, C, ldc);
+}
+
+template <class R>
+bool fixed_block(int, int, int, R, const GemmOperandOf<R> &,
+                 const GemmOperandOf<R> &, R, R *, int) {
+    return false;
+}
+
+// Runs the full blocked loop nest for an M x N block of C. Every call packs
+// into the calling thread's own buffers, so blocks can run concurrently.
+// Blocks small enough for a Matrix<M, K> specialization skip packing and go
+// straight to the unrolled kernel instead. The epilogue, if any, is fused
+// into the last K block.
+template <class R>
+void gemm_block(const GemmKernelOf<R> &kernel, int M, int N, int K, R alpha,
+                GemmOperandOf<R> a, GemmOperandOf<R> b, R beta, R *C, int ldc,
+                const GemmEpilogueOf<R> &epilogue = GemmEpilogueOf<R>()) {
+    bool fused = has_epilogue(epilogue);
+
+    if (fixed_block(M, N, K, alpha, a, b, beta, C, ldc)) {
+        if (fused) {
+            apply_epilogue(epilogue, M, N, C, ldc);
+        }
+        return;
+    }
+
+    const GemmBlocking &blk = kernel.blocking;
+
+    thread_local AlignedBuffer buffer_a;
+    thread_local AlignedBuffer buffer_b;
+
+    int mc_max = std::min(blk.mc, (M + blk.mr - 1) / blk.mr * blk.mr);
+    int nc_max = std::min(blk.nc, (N + blk.nr - 1) / blk.nr * blk.nr);
+    int kc_max = std::min(blk.kc, K);
+
+    R *packed_a = buffer_a.reserve_as<R>((size_t)mc_max * kc_max);
+    R *packed_b =
+        b.packed ? nullptr : buffer_b.reserve_as<R>((size_t)kc_max * nc_max);
+
+    for (int jc = 0; jc < N; jc += blk.nc) {
+        int nc = std::min(blk.nc, N - jc);
+
+        for (int pc = 0; pc < K; pc += blk.kc) {
+            int kc = std::min(blk.kc, K - pc);
+            // Only the first K block applies the caller's beta; the rest
+            // accumulate onto the partial result already stored in C.
+            R beta_block = pc == 0 ? beta : R(1);
+            bool last = pc + kc == K;
+
+            const R *panels;
+            if (b.packed) {
+                panels = packed_panels(b, pc, jc);
+            } else {
+                pack_operand_b(blk.nr, kc, nc, operand_at(b, pc, jc),
+                               packed_b);
+                panels = packed_b;
+            }
+
+            for (int ic = 0; ic < M; ic += blk.mc) {
+                int mc = std::min(blk.mc, M - ic);
+
+                pack_operand_a(blk.mr, mc, kc, operand_at(a, ic, pc),
+                               packed_a);
+
+                GemmEpilogueOf<R> block_epilogue =
+                    epilogue_at(epilogue, ic, jc);
+                macro_kernel(kernel, mc, nc, kc, packed_a, panels,
+                             C + (size_t)ic * ldc + jc, ldc, alpha,
+                             beta_block,
+                             fused && last ? &block_epilogue : nullptr);
+            }
+        }
+    }
+}
+
+// Complex blocks are split into real planes by complex_gemm_block, and the
+// epilogue, if any, is applied to the finished block
+template <class R>
+void gemm_block(const ComplexGemmKernel<R> &kernel, int M, int N, int K,
+                std::complex<R> alpha, GemmOperandOf<std::complex<R>> a,
+                GemmOperandOf<std::complex<R>> b, std::complex<R> beta,
+                std::complex<R> *C, int ldc,
+                const GemmEpilogueOf<std::complex<R>> &epilogue =
+                    GemmEpilogueOf<std::complex<R>>()) {
+    complex_gemm_block(kernel, M, N, K, alpha,
+                       GemmStrided<std::complex<R>>{a.data, a.rs, a.cs, a.conj},
+                       GemmStrided<std::complex<R>>{b.data, b.rs, b.cs, b.conj},
+                       beta, C, ldc);
+    if (has_epilogue(epilogue)) {
+        apply_epilogue(epilogue, M, N, C, ldc);
+    }
+}
+
+int round_up(int value, int multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+int ceil_div(int value, int divisor) { return (value + divisor - 1) / divisor; }
+
+// 2D partition of C into tiles that are whole multiples of the register
+// tile. Rows are cut at mc first since that keeps every tile's packed A block
+// at full size, then columns and finally rows again until there are at least
+// `target` tiles.
+struct GemmTiling {
+    int tile_m;
+    int tile_n;
+    int tiles_m;
+    int tiles_n;
+
+    int count() const { return tiles_m * tiles_n; }
+};
+
+GemmTiling gemm_tiling(const GemmBlocking &blk, int M, int N, int target) {
+    GemmTiling tiling;
+    tiling.tile_m = std::min(blk.mc, round_up(M, blk.mr));
+    tiling.tiles_m = ceil_div(M, tiling.tile_m);
+
+    int split_n = std::max(1, ceil_div(target, tiling.tiles_m));
+    tiling.tile_n = std::min(round_up(N, blk.nr),
+                             round_up(ceil_div(N, split_n), blk.nr));
+    tiling.tiles_n = ceil_div(N, tiling.tile_n);
+
+    if (tiling.count() < target) {
+        int split_m = ceil_div(target, tiling.tiles_n);
+        tiling.tile_m = std::min(tiling.tile_m,
+                                 round_up(ceil_div(M, split_m), blk.mr));
+        tiling.tiles_m = ceil_div(M, tiling.tile_m);
+    }
+    return tiling;
+}
+
+// One C = alpha * A * B + beta * C product with an M x K operand A and a
+// K x N operand B
+template <class T> struct GemmProblemOf {
+    int M;
+    int N;
+    int K;
+    T alpha;
+    GemmOperandOf<T> a;
+    GemmOperandOf<T> b;
+    T beta;
+    T *C;
+    int ldc;
+    GemmEpilogueOf<T> epilogue;
+};
+
+typedef GemmProblemOf<float> GemmProblem;
+
+// C = beta * C followed by the epilogue, for products where A * B
+// contributes nothing
+template <class T> void gemm_scale(const GemmProblemOf<T> &p) {
+    for (int i = 0; i < p.M; ++i) {
+        T *row = p.C + (size_t)i * p.ldc;
+        for (int j = 0; j < p.N; ++j) {
+            row[j] = p.beta == T(0) ? T(0) : p.beta * row[j];
+        }
+    }
+    if (has_epilogue(p.epilogue)) {
+        apply_epilogue(p.epilogue, p.M, p.N, p.C, p.ldc);
+    }
+}
+
+// Computes one tile of a problem cut up by gemm_tiling
+template <class Kernel, class T>
+void gemm_tile(const Kernel &kernel, const GemmProblemOf<T> &p,
+               const GemmTiling &tiling, int tile) {
+    int ic = (tile / tiling.tiles_n) * tiling.tile_m;
+    int jc = (tile % tiling.tiles_n) * tiling.tile_n;
+    int m = std::min(tiling.tile_m, p.M - ic);
+    int n = std::min(tiling.tile_n, p.N - jc);
+
+    gemm_block(kernel, m, n, p.K, p.alpha, operand_at(p.a, ic, 0),
+               operand_at(p.b, 0, jc), p.beta, p.C + (size_t)ic * p.ldc + jc,
+               p.ldc, epilogue_at(p.epilogue, ic, jc));
+}
+
+// Split-K cuts K into chunks of at least this depth ...
+constexpr int SPLITK_MIN_DEPTH = 512;
+
+// ... and into at most this many chunks ...
+constexpr int SPLITK_MAX_SPLITS = 64;
+
+// ... and into no more chunks than this many bytes of partial planes hold
+// (one at least). The workspace lives as long as the thread that ran the
+// product, so it must not grow with the number of chunks.
+constexpr size_t SPLITK_MAX_WORKSPACE = (size_t)64 << 20;
+
+// Auto only runs split-K for outputs of at most SPLITK_AUTO_MAX_TILES tiles
+// of SPLITK_AUTO_TILE x SPLITK_AUTO_TILE; larger ones keep every core busy
+// with 2D tiles alone
+constexpr int SPLITK_AUTO_TILE = 128;
+constexpr int SPLITK_AUTO_MAX_TILES = 16;
+
+// Rows of C per reduction task
+constexpr int SPLITK_REDUCE_ROWS = 16;
+
+// Shape-only test for reduction-heavy products that Auto runs as split-K.
+// It must not look at the thread count, or results would change with it.
+template <class T> bool prefers_split_k(const GemmProblemOf<T> &p) {
+    size_t tiles = (size_t)ceil_div(p.M, SPLITK_AUTO_TILE) *
+                   ceil_div(p.N, SPLITK_AUTO_TILE);
+    return tiles <= SPLITK_AUTO_MAX_TILES && p.K >= 2 * SPLITK_MIN_DEPTH &&
+           p.K >= 8 * std::max(p.M, p.N);
+}
+
+// Split-K: K is cut into S chunks whose number and boundaries depend only on
+// the shape and the kernel, never on the thread count. Every chunk computes
+// an unscaled partial product into its own M x N plane of a workspace; with
+// alpha = 1 and beta = 0 the micro-kernel stores are exact, so partials do
+// not depend on how the chunk was tiled either. The planes are then summed
+// in a fixed pairwise tree (plane s += plane s + stride, stride doubling)
+// and alpha/beta are applied last. Every element of C therefore sees the
+// same sequence of floating point operations for any number of workers.
+template <class Kernel, class T>
+void gemm_split_k_driver(const Kernel &kernel, const GemmProblemOf<T> &p) {
+    WorkStealingScheduler &scheduler = WorkStealingScheduler::instance();
+    const GemmBlocking &blk = kernel.blocking;
+
+    size_t plane = (size_t)p.M * p.N;
+    int planes = (int)std::min<size_t>(
+        SPLITK_MAX_SPLITS, SPLITK_MAX_WORKSPACE / (plane * sizeof(T)));
+    int splits = std::max(1, std::min(planes, p.K / SPLITK_MIN_DEPTH));
+    int chunk = round_up(ceil_div(p.K, splits), blk.kc);
+    splits = ceil_div(p.K, chunk);
+
+    thread_local AlignedBuffer workspace;
+    T *partials = workspace.reserve_as<T>(plane * splits);
+
+    GemmTiling tiling = gemm_tiling(
+        blk, p.M, p.N,
+        std::max(1, ceil_div(scheduler.size() * GEMM_TILES_PER_WORKER,
+                             splits)));
+    int tiles = tiling.count();
+
+    scheduler.parallelFor(splits * tiles, [&](int task, int) {
+        int split = task / tiles;
+        int k0 = split * chunk;
+
+        GemmProblemOf<T> part = p;
+        part.K = std::min(chunk, p.K - k0);
+        part.alpha = T(1);
+        part.a = operand_at(p.a, 0, k0);
+        part.b = operand_at(p.b, k0, 0);
+        part.beta = T(0);
+        part.C = partials + split * plane;
+        part.ldc = p.N;
+        part.epilogue = GemmEpilogueOf<T>();
+        gemm_tile(kernel, part, tiling, task % tiles);
+    });
+
+    scheduler.parallelFor(ceil_div(p.M, SPLITK_REDUCE_ROWS), [&](int task,
+                                                                  int) {
+        int i0 = task * SPLITK_REDUCE_ROWS;
+        int i1 = std::min(p.M, i0 + SPLITK_REDUCE_ROWS);
+        size_t begin = (size_t)i0 * p.N;
+        size_t end = (size_t)i1 * p.N;
+
+        for (int stride = 1; stride < splits; stride *= 2) {
+            for (int split = 0; split + stride < splits; split += 2 * stride) {
+                T *dst = partials + split * plane;
+                const T *src = partials + (split + stride) * plane;
+                for (size_t e = begin; e < end; ++e) {
+                    dst[e] += src[e];
+                }
+            }
+        }
+
+        for (int i = i0; i < i1; ++i) {
+            const T *sum = partials + (size_t)i * p.N;
+            T *row = p.C + (size_t)i * p.ldc;
+            if (p.beta == T(0)) {
+                for (int j = 0; j < p.N; ++j) {
+                    row[j] = p.alpha * sum[j];
+                }
+            } else {
+                for (int j = 0; j < p.N; ++j) {
+                    row[j] = p.alpha * sum[j] + p.beta * row[j];
+                }
+            }
+        }
+
+        if (has_epilogue(p.epilogue)) {
+            apply_epilogue(epilogue_at(p.epilogue, i0, 0), i1 - i0, p.N,
+                           p.C + (size_t)i0 * p.ldc, p.ldc);
+        }
+    });
+}
+
+// Stream-K tiles are mc rows by up to this many columns
+constexpr int STREAMK_TILE_N = 512;
+
+// Partial tile left by a Stream-K worker, to be combined in the fix-up
+template <class T> struct StreamKPartial {
+    int tile = -1;      // Tile index, -1 for an unused slot
+    int segment = 0;    // First K iteration covered, orders the partials
+    T *data = nullptr;
+};
+
+// Stream-K: the output is cut into tiles, each tile into K iterations of kc,
+// and every worker gets an equal contiguous share of the iterations of all
+// tiles, crossing tile boundaries as needed. No worker waits on a ragged last
+// wave of tiles. Tiles a worker covers completely are written straight to C;
+// the at most two tiles at the ends of its share are computed as unscaled
+// partials into a workspace, and a fix-up pass sums each split tile's
+// partials in K order and applies alpha/beta.
+template <class Kernel, class T>
+void gemm_stream_k_driver(const Kernel &kernel, const GemmProblemOf<T> &p) {
+    ThreadPool &pool = ThreadPool::instance();
+    WorkStealingScheduler &scheduler = WorkStealingScheduler::instance();
+    const GemmBlocking &blk = kernel.blocking;
+
+    int tile_m = std::min(blk.mc, round_up(p.M, blk.mr));
+    int tile_n = round_up(std::min(p.N, STREAMK_TILE_N), blk.nr);
+    int tiles_n = ceil_div(p.N, tile_n);
+    int tiles = ceil_div(p.M, tile_m) * tiles_n;
+    int iters_per_tile = ceil_div(p.K, blk.kc);
+    long long total_iters = (long long)tiles * iters_per_tile;
+
+    int workers = pool.size();
+    size_t slot = (size_t)tile_m * tile_n;
+    thread_local AlignedBuffer workspace;
+    T *slots = workspace.reserve_as<T>(slot * 2 * workers);
+    std::vector<StreamKPartial<T>> partials(2 * workers);
+
+    pool.run([&](int worker) {
+        long long begin = total_iters * worker / workers;
+        long long end = total_iters * (worker + 1) / workers;
+        int used = 0;
+
+        while (begin < end) {
+            int tile = (int)(begin / iters_per_tile);
+            long long tile_begin = (long long)tile * iters_per_tile;
+            int seg_begin = (int)(begin - tile_begin);
+            int seg_end = (int)(std::min(end, tile_begin + iters_per_tile) -
+                                tile_begin);
+            begin = tile_begin + seg_end;
+
+            int ic = (tile / tiles_n) * tile_m;
+            int jc = (tile % tiles_n) * tile_n;
+            int m = std::min(tile_m, p.M - ic);
+            int n = std::min(tile_n, p.N - jc);
+            int k0 = seg_begin * blk.kc;
+            int k1 = std::min(p.K, seg_end * blk.kc);
+
+            GemmOperandOf<T> a = operand_at(p.a, ic, k0);
+            GemmOperandOf<T> b = operand_at(p.b, k0, jc);
+
+            if (seg_begin == 0 && seg_end == iters_per_tile) {
+                gemm_block(kernel, m, n, p.K, p.alpha, a, b, p.beta,
+                           p.C + (size_t)ic * p.ldc + jc, p.ldc,
+                           epilogue_at(p.epilogue, ic, jc));
+                continue;
+            }
+
+            StreamKPartial<T> &partial = partials[2 * worker + used];
+            partial.tile = tile;
+            partial.segment = seg_begin;
+            partial.data = slots + (2 * worker + used) * slot;
+            ++used;
+            gemm_block(kernel, m, n, k1 - k0, T(1), a, b, T(0), partial.data,
+                       tile_n);
+        }
+    });
+
+    std::vector<StreamKPartial<T>> split;
+    for (const StreamKPartial<T> &partial : partials) {
+        if (partial.tile >= 0) {
+            split.push_back(partial);
+        }
+    }
+    if (split.empty()) {
+        return;
+    }
+
+    std::sort(split.begin(), split.end(),
+              [](const StreamKPartial<T> &x, const StreamKPartial<T> &y) {
+                  return x.tile != y.tile ? x.tile < y.tile
+                                          : x.segment < y.segment;
+              });
+
+    std::vector<size_t> firsts;
+    for (size_t i = 0; i < split.size(); ++i) {
+        if (i == 0 || split[i].tile != split[i - 1].tile) {
+            firsts.push_back(i);
+        }
+    }
+    firsts.push_back(split.size());
+
+    scheduler.parallelFor((int)firsts.size() - 1, [&](int task, int) {
+        size_t first = firsts[task];
+        size_t last = firsts[task + 1];
+        int tile = split[first].tile;
+        int ic = (tile / tiles_n) * tile_m;
+        int jc = (tile % tiles_n) * tile_n;
+        int m = std::min(tile_m, p.M - ic);
+        int n = std::min(tile_n, p.N - jc);
+
+        T *sum = split[first].data;
+        for (size_t i = first + 1; i < last; ++i) {
+            for (int r = 0; r < m; ++r) {
+                T *dst = sum + (size_t)r * tile_n;
+                const T *src = split[i].data + (size_t)r * tile_n;
+                for (int j = 0; j < n; ++j) {
+                    dst[j] += src[j];
+                }
+            }
+        }
+
+        for (int r = 0; r < m; ++r) {
+            const T *src = sum + (size_t)r * tile_n;
+            T *row = p.C + (size_t)(ic + r) * p.ldc + jc;
+            if (p.beta == T(0)) {
+                for (int j = 0; j < n; ++j) {
+                    row[j] = p.alpha * src[j];
+                }
+            } else {
+                for (int j = 0; j < n; ++j) {
+                    row[j] = p.alpha * src[j] + p.beta * row[j];
+                }
+            }
+        }
+
+        if (has_epilogue(p.epilogue)) {
+            apply_epilogue(epilogue_at(p.epilogue, ic, jc), m, n,
+                           p.C + (size_t)ic * p.ldc + jc, p.ldc);
+        }
+    });
+}
+
+// Products with a single row or column of C (GEMV) or a depth of one
+// (rank-1 update) read every element of the larger operand once, so packing
+// for the micro-kernel is pure overhead. These run on the bandwidth bound
+// kernels of Gemv.hpp instead; returns false for every other shape.
+template <class R> bool gemm_degenerate(const GemmProblemOf<R> &p) {
+    if (!is_plain(p.a) || !is_plain(p.b)) {
+        return false;
+    }
+
+    if (p.N == 1) {
+        gemv_strided(p.M, p.K, p.alpha, p.a.data, p.a.rs, p.a.cs, p.b.data,
+                     p.b.rs, p.beta, p.C, p.ldc);
+    } else if (p.M == 1) {
+        // The single row of C is B^T * a
+        gemv_strided(p.N, p.K, p.alpha, p.b.data, p.b.cs, p.b.rs, p.a.data,
+                     p.a.cs, p.beta, p.C, 1);
+    } else if (p.K == 1) {
+        rank1_strided(p.M, p.N, p.alpha, p.a.data, p.a.rs, p.b.data, p.b.cs,
+                      p.beta, p.C, p.ldc);
+    } else {
+        return false;
+    }
+
+    if (has_epilogue(p.epilogue)) {
+        apply_epilogue(p.epilogue, p.M, p.N, p.C, p.ldc);
+    }
+    return true;
+}
+
+// There are no complex GEMV kernels, so complex products always take the
+// blocked path
+template <class R>
+bool gemm_degenerate(const GemmProblemOf<std::complex<R>> &) {
+    return false;
+}
+
+// Large problems are cut into 2D tiles of C that are load balanced over the
+// thread pool by the work-stealing scheduler, or run split-K or Stream-K
+// when the schedule asks for it. Degenerate shapes bypass the schedule.
+template <class Kernel, class T>
+void gemm_driver(const Kernel &kernel, const GemmProblemOf<T> &p) {
+    if (p.M <= 0 || p.N <= 0) {
+        return;
+    }
+
+    if (p.K <= 0 || p.alpha == T(0)) {
+        gemm_scale(p);
+        return;
+    }
+
+    if (gemm_degenerate(p)) {
+        return;
+    }
+
+    WorkStealingScheduler &scheduler = WorkStealingScheduler::instance();
+
+    double work = (double)p.M * p.N * p.K;
+    if (work < GEMM_PARALLEL_MIN_WORK) {
+        gemm_block(kernel, p.M, p.N, p.K, p.alpha, p.a, p.b, p.beta, p.C,
+                   p.ldc, p.epilogue);
+        return;
+    }
+
+    GemmSchedule schedule = host_gemm_schedule();
+    if (schedule == GemmSchedule::Auto) {
+        schedule = prefers_split_k(p) ? GemmSchedule::SplitK
+                                      : GemmSchedule::Tiled;
+    }
+
+    // Split-K runs even on a single worker so that its results stay the
+    // same for every thread count
+    if (schedule == GemmSchedule::SplitK) {
+        gemm_split_k_driver(kernel, p);
+        return;
+    }
+
+    if (scheduler.size() == 1) {
+        gemm_block(kernel, p.M, p.N, p.K, p.alpha, p.a, p.b, p.beta, p.C,
+                   p.ldc, p.epilogue);
+        return;
+    }
+
+    if (schedule == GemmSchedule::StreamK) {
+        gemm_stream_k_driver(kernel, p);
+        return;
+    }
+
+    GemmTiling tiling = gemm_tiling(kernel.blocking, p.M, p.N,
+                                    scheduler.size() * GEMM_TILES_PER_WORKER);
+
+    scheduler.parallelFor(tiling.count(), [&](int tile, int) {
+        gemm_tile(kernel, p, tiling, tile);
+    });
+}
+
+// Float products run on the micro-kernel picked for this CPU
+void gemm_driver(const GemmProblem &p) { gemm_driver(gemm_kernel(), p); }
+
+// Rows of A up to which sgemm_int4 and sgemm_mx stream a quantized B instead
+// of packing it. Such products are bound by reading B, and packing would
+// write and read it again as floats, four to eight times its quantized size.
+constexpr int STREAM_MAX_M = 8;
+
+// Columns per chunk of a streamed product; one dequantized row segment and
+// the accumulators of every row of C stay in L1
+constexpr int STREAM_COLS = 256;
+
+// Runs a streamed product in chunks of STREAM_COLS columns of C, spread over
+// the scheduler. product(j0, n, acc) stores the unscaled product of columns
+// [j0, j0 + n) into acc, a row of STREAM_COLS floats per row of C; alpha,
+// beta and the epilogue are applied here.
+template <class Fn>
+void stream_columns(const GemmProblem &p, const Fn &product) {
+    WorkStealingScheduler &scheduler = WorkStealingScheduler::instance();
+
+    auto run = [&](int chunk) {
+        int j0 = chunk * STREAM_COLS;
+        int n = std::min(STREAM_COLS, p.N - j0);
+
+        thread_local AlignedBuffer buffer;
+        float *acc = buffer.reserve((size_t)p.M * STREAM_COLS);
+        product(j0, n, acc);
+
+        for (int i = 0; i < p.M; ++i) {
+            float *c = p.C + (size_t)i * p.ldc + j0;
+            const float *sums = acc + (size_t)i * STREAM_COLS;
+            for (int j = 0; j < n; ++j) {
+                c[j] = p.beta == 0.0f ? p.alpha * sums[j]
+                                      : p.alpha * sums[j] + p.beta * c[j];
+            }
+        }
+        if (has_epilogue(p.epilogue)) {
+            apply_epilogue(epilogue_at(p.epilogue, 0, j0), p.M, n, p.C + j0,
+                           p.ldc);
+        }
+    };
+
+    int chunks = ceil_div(p.N, STREAM_COLS);
+    if (scheduler.size() == 1 ||
+        (double)p.M * p.N * p.K < GEMM_PARALLEL_MIN_WORK) {
+        for (int chunk = 0; chunk < chunks; ++chunk) {
+            run(chunk);
+        }
+        return;
+    }
+    scheduler.parallelFor(chunks, [&](int chunk, int) { run(chunk); });
+}
+
+// acc[i][j] += sum_k A(i, k) * B(k, col + j) over all K rows of w, for m
+// rows of A and n <= STREAM_COLS columns. row, scale and offset are
+// STREAM_COLS floats of scratch each.
+inline __attribute__((always_inline)) void
+int4_stream_body(const Int4MatrixB &w, int m, int col, int n, const float *A,
+                 ptrdiff_t rs, ptrdiff_t cs, float *acc, float *row,
+                 float *scale, float *offset) {
+    for (int k = 0; k < w.K; ++k) {
+        if (k % w.group_size == 0) {
+            int4_group_terms(w, k, col, n, scale, offset);
+        }
+        dequantize_int4_row(w, k, col, n, scale, offset, row);
+        for (int i = 0; i < m; ++i) {
+            float a = A[(ptrdiff_t)i * rs + (ptrdiff_t)k * cs];
+            float *sums = acc + (size_t)i * STREAM_COLS;
+            for (int j = 0; j < n; ++j) {
+                sums[j] += a * row[j];
+            }
+        }
+    }
+}
+
+typedef void (*Int4StreamKernel)(const Int4MatrixB &w, int m, int col, int n,
+                                 const float *A, ptrdiff_t rs, ptrdiff_t cs,
+                                 float *acc, float *row, float *scale,
+                                 float *offset);
+
+// The streaming loop is bound by unpacking and converting nibbles, so it
+// is compiled once per vector width like the other host kernels
+#define INT4_STREAM_KERNEL(SUFFIX, TARGET)                                     \
+    TARGET void int4_stream_##SUFFIX(const Int4MatrixB &w, int m, int col,     \
+                                     int n, const float *A, ptrdiff_t rs,      \
+                                     ptrdiff_t cs, float *acc, float *row,     \
+                                     float *scale, float *offset) {            \
+        int4_stream_body(w, m, col, n, A, rs, cs, acc, row, scale, offset);    \
+    }
+
+INT4_STREAM_KERNEL(generic, )
+
+#ifdef HOST_GEMM_X86
+INT4_STREAM_KERNEL(avx2, __attribute__((target("avx2,fma"))))
+INT4_STREAM_KERNEL(avx512, __attribute__((target("avx512f"))))
+#endif
+
+Int4StreamKernel select_int4_stream_kernel() {
+#ifdef HOST_GEMM_X86
+    const CpuFeatures &cpu = cpu_features();
+    if (cpu.avx512f) {
+        return int4_stream_avx512;
+    }
+    if (cpu.avx2 && cpu.fma) {
+        return int4_stream_avx2;
+    }
+#endif
+    return int4_stream_generic;
+}
+
+// C = alpha * A * B + beta * C for a B in Int4 storage and at most
+// STREAM_MAX_M rows: every row of B is dequantized once per column chunk and
+// accumulated into all rows of C
+void int4_stream(const GemmProblem &p) {
+    static const Int4StreamKernel kernel = select_int4_stream_kernel();
+    const Int4MatrixB &w = *static_cast<const Int4MatrixB *>(p.b.source);
+
+    stream_columns(p, [&](int j0, int n, float *acc) {
+        thread_local AlignedBuffer buffer;
+        float *row = buffer.reserve((size_t)3 * STREAM_COLS);
+        float *scale = row + STREAM_COLS;
+        float *offset = scale + STREAM_COLS;
+        std::fill(acc, acc + (size_t)p.M * STREAM_COLS, 0.0f);
+        kernel(w, p.M, j0, n, p.a.data, p.a.rs, p.a.cs, acc, row, scale,
+               offset);
+    });
+}
+
+// acc[i][j] += sum_k A(i, k) * B(k, col + j) for an MxMatrix holding B,
+// whose rows run across the columns: like int4_stream_body, every row of B
+// is decoded once per column chunk. row is STREAM_COLS floats of scratch.
+inline __attribute__((always_inline)) void
+mx_stream_body(const MxMatrix &mx, int m, int col, int n, const float *A,
+               ptrdiff_t rs, ptrdiff_t cs, float *acc, float *row) {
+    for (int k = 0; k < mx.rows; ++k) {
+        mx_decode_row(mx, k, col, n, row);
+        for (int i = 0; i < m; ++i) {
+            float a = A[(ptrdiff_t)i * rs + (ptrdiff_t)k * cs];
+            float *sums = acc + (size_t)i * STREAM_COLS;
+            for (int j = 0; j < n; ++j) {
+                sums[j] += a * row[j];
+            }
+        }
+    }
+}
+
+typedef void (*MxStreamKernel)(const MxMatrix &mx, int m, int col, int n,
+                               const float *A, ptrdiff_t rs, ptrdiff_t cs,
+                               float *acc, float *row);
+
+#define MX_STREAM_KERNEL(SUFFIX, TARGET)                                       \
+    TARGET void mx_stream_##SUFFIX(const MxMatrix &mx, int m, int col, int n,  \
+                                   const float *A, ptrdiff_t rs,               \
+                                   ptrdiff_t cs, float *acc, float *row) {     \
+        mx_stream_body(mx, m, col, n, A, rs, cs, acc, row);                    \
+    }
+
+MX_STREAM_KERNEL(generic, )
+
+#ifdef HOST_GEMM_X86
+MX_STREAM_KERNEL(avx2, __attribute__((target("avx2,fma"))))
+MX_STREAM_KERNEL(avx512, __attribute__((target("avx512f"))))
+#endif
+
+MxStreamKernel select_mx_stream_kernel() {
+#ifdef HOST_GEMM_X86
+    const CpuFeatures &cpu = cpu_features();
+    if (cpu.avx512f) {
+        return mx_stream_avx512;
+    }
+    if (cpu.avx2 && cpu.fma) {
+        return mx_stream_avx2;
+    }
+#endif
+    return mx_stream_generic;
+}
+
+// C = alpha * A * B + beta * C for a float A of at most STREAM_MAX_M rows and
+// a B in Mx storage, decoding every block of B once instead of packing it
+void mx_stream(const GemmProblem &p) {
+    const MxMatrix &mx = *static_cast<const MxMatrix *>(p.b.source);
+
+    if (!p.b.transposed) {
+        static const MxStreamKernel kernel = select_mx_stream_kernel();
+        stream_columns(p, [&](int j0, int n, float *acc) {
+            thread_local AlignedBuffer buffer;
+            float *row = buffer.reserve(STREAM_COLS);
+            std::fill(acc, acc + (size_t)p.M * STREAM_COLS, 0.0f);
+            kernel(mx, p.M, j0, n, p.a.data, p.a.rs, p.a.cs, acc, row);
+        });
+        return;
+    }
+
+    // B^T has its blocks along K, so column j of C is the dot products of
+    // row j of the MxMatrix with the rows of A, which mx_dot_row reads
+    // contiguously; a gather belongs to the calling thread and is only read
+    // by the workers
+    thread_local AlignedBuffer buffer_a;
+    const float *a = p.a.data;
+    int lda = p.a.rs;
+    if (p.a.cs != 1) {
+        float *gathered = buffer_a.reserve((size_t)p.M * p.K);
+        for (int i = 0; i < p.M; ++i) {
+            for (int k = 0; k < p.K; ++k) {
+                gathered[(size_t)i * p.K + k] =
+                    a[(ptrdiff_t)i * p.a.rs + (ptrdiff_t)k * p.a.cs];
+            }
+        }
+        a = gathered;
+        lda = p.K;
+    }
+
+    stream_columns(p, [&](int j0, int n, float *acc) {
+        float dots[STREAM_MAX_M];
+        for (int j = 0; j < n; ++j) {
+            mx_dot_row(mx, j0 + j, p.M, a, lda, dots);
+            for (int i = 0; i < p.M; ++i) {
+                acc[(size_t)i * STREAM_COLS + j] = dots[i];
+            }
+        }
+    });
+}
+
+// Runs `batch` problems shaped like `first`, member i using operands offset
+// by i times the batch strides. All tiles of all members go to the scheduler
+// as one parallel region; small members are not split at all.
+void gemm_batched_driver(const GemmProblem &first, ptrdiff_t strideA,
+                         ptrdiff_t strideB, ptrdiff_t strideC, int batch) {
+    if (batch <= 0 || first.M <= 0 || first.N <= 0) {
+        return;
+    }
+
+    auto member = [&](int i) {
+        GemmProblem p = first;
+        p.a.data += i * strideA;
+        p.b.data += i * strideB; // Batched B is never pre-packed
+        p.C += i * strideC;
+        return p;
+    };
+
+    if (first.K <= 0 || first.alpha == 0.0f) {
+        for (int i = 0; i < batch; ++i) {
+            gemm_scale(member(i));
+        }
+        return;
+    }
+
+    const GemmKernel &kernel = gemm_kernel();
+    WorkStealingScheduler &scheduler = WorkStealingScheduler::instance();
+
+    double work = (double)batch * first.M * first.N * first.K;
+    if (scheduler.size() == 1 || work < GEMM_PARALLEL_MIN_WORK) {
+        for (int i = 0; i < batch; ++i) {
+            GemmProblem p = member(i);
+            gemm_block(kernel, p.M, p.N, p.K, p.alpha, p.a, p.b, p.beta, p.C,
+                       p.ldc, p.epilogue);
+        }
+        return;
+    }
+
+    int target =
+        ceil_div(scheduler.size() * GEMM_TILES_PER_WORKER, batch);
+    GemmTiling tiling = gemm_tiling(kernel.blocking, first.M, first.N, target);
+    int tiles = tiling.count();
+
+    scheduler.parallelFor(batch * tiles, [&](int task, int) {
+        gemm_tile(kernel, member(task / tiles), tiling, task % tiles);
+    });
+}
+
+// Runs a group of independent problems of different shapes. Every problem is
+// tiled in proportion to its share of the total work and all tiles are
+// scheduled together, largest problems first, so small members fill in
+// around the large ones instead of each getting a parallel region of its own.
+void gemm_grouped_driver(const std::vector<GemmProblem> &problems) {
+    std::vector<int> order;
+    double total_work = 0.0;
+
+    for (int i = 0; i < (int)problems.size(); ++i) {
+        const GemmProblem &p = problems[i];
+        if (p.M <= 0 || p.N <= 0) {
+            continue;
+        }
+        if (p.K <= 0 || p.alpha == 0.0f) {
+            gemm_scale(p);
+            continue;
+        }
+        order.push_back(i);
+        total_work += (double)p.M * p.N * p.K;
+    }
+
+    if (order.empty()) {
+        return;
+    }
+
+    const GemmKernel &kernel = gemm_kernel();
+    WorkStealingScheduler &scheduler = WorkStealingScheduler::instance();
+
+    if (scheduler.size() == 1 || total_work < GEMM_PARALLEL_MIN_WORK) {
+        for (int i : order) {
+            const GemmProblem &p = problems[i];
+            gemm_block(kernel, p.M, p.N, p.K, p.alpha, p.a, p.b, p.beta, p.C,
+                       p.ldc, p.epilogue);
+        }
+        return;
+    }
+
+    auto work = [&](int i) {
+        const GemmProblem &p = problems[i];
+        return (double)p.M * p.N * p.K;
+    };
+    std::stable_sort(order.begin(), order.end(),
+                     [&](int x, int y) { return work(x) > work(y); });
+
+    int target = scheduler.size() * GEMM_TILES_PER_WORKER;
+    std::vector<GemmTiling> tilings(order.size());
+    std::vector<int> first_tile(order.size() + 1, 0);
+
+    for (size_t t = 0; t < order.size(); ++t) {
+        const GemmProblem &p = problems[order[t]];
+        int share = (int)std::ceil(target * work(order[t]) / total_work);
+        tilings[t] = gemm_tiling(kernel.blocking, p.M, p.N, share);
+        first_tile[t + 1] = first_tile[t] + tilings[t].count();
+    }
+
+    scheduler.parallelFor(first_tile.back(), [&](int task, int) {
+        size_t t = std::upper_bound(first_tile.begin(), first_tile.end(),
+                                    task) -
+                   first_tile.begin() - 1;
+        gemm_tile(kernel, problems[order[t]], tilings[t],
+                  task - first_tile[t]);
+    });
+}
+
+// Diagonal blocks of a symmetric update are computed in full into scratch
+// and only their triangle is stored, so the block size bounds the wasted work
+// at about SYRK_MAX_BLOCK / N
+constexpr int SYRK_MAX_BLOCK = 256;
+
+// Blocks of mirror_triangle, transposed through L1
+constexpr int MIRROR_BLOCK = 64;
+
+// Rank-k or rank-2k update of one triangle of the N x N matrix C:
+//     C = alpha * (a * b + a2 * b2) + beta * C
+// with N x K operands a, a2 and K x N operands b, b2 (the rank-2k terms)
+struct SyrkProblem {
+    bool lower;
+    int N;
+    int K;
+    float alpha;
+    GemmOperand a;
+    GemmOperand b;
+    bool rank2;
+    GemmOperand a2;
+    GemmOperand b2;
+    float beta;
+    float *C;
+    int ldc;
+};
+
+// Columns [j0, j1) of row i that belong to the triangle
+void triangle_row(bool lower, int N, int i, int &j0, int &j1) {
+    j0 = lower ? 0 : i;
+    j1 = lower ? i + 1 : N;
+}
+
+// The triangle is cut into square blocks of C; blocks off the diagonal are
+// plain gemm_blocks, diagonal ones go through scratch so that nothing
+// outside the triangle is written. All blocks are load balanced together.
+void syrk_driver(const SyrkProblem &p) {
+    if (p.N <= 0) {
+        return;
+    }
+
+    if (p.K <= 0 || p.alpha == 0.0f) {
+        for (int i = 0; i < p.N; ++i) {
+            int j0, j1;
+            triangle_row(p.lower, p.N, i, j0, j1);
+            float *row = p.C + (size_t)i * p.ldc;
+            for (int j = j0; j < j1; ++j) {
+                row[j] = p.beta == 0.0f ? 0.0f : p.beta * row[j];
+            }
+        }
+        return;
+    }
+
+    const GemmKernel &kernel = gemm_kernel();
+    WorkStealingScheduler &scheduler = WorkStealingScheduler::instance();
+    double work = (p.rank2 ? 1.0 : 0.5) * p.N * p.N * p.K;
+    bool parallel = scheduler.size() > 1 && work >= GEMM_PARALLEL_MIN_WORK;
+
+    // Enough blocks per side that the triangle has a few tiles per worker
+    int side = 1;
+    int target = parallel ? scheduler.size() * GEMM_TILES_PER_WORKER : 1;
+    while (side * (side + 1) / 2 < target) {
+        ++side;
+    }
+    int nb = std::min(SYRK_MAX_BLOCK,
+                      round_up(ceil_div(p.N, side), kernel.blocking.mr));
+    int blocks = ceil_div(p.N, nb);
+
+    std::vector<std::pair<int, int>> tiles;
+    for (int bi = 0; bi < blocks; ++bi) {
+        for (int bj = p.lower ? 0 : bi; bj <= (p.lower ? bi : blocks - 1);
+             ++bj) {
+            tiles.emplace_back(bi, bj);
+        }
+    }
+
+    auto run_tile = [&](int tile) {
+        int i0 = tiles[tile].first * nb;
+        int j0 = tiles[tile].second * nb;
+        int m = std::min(nb, p.N - i0);
+        int n = std::min(nb, p.N - j0);
+        GemmOperand a = operand_at(p.a, i0, 0);
+        GemmOperand b = operand_at(p.b, 0, j0);
+        GemmOperand a2 = operand_at(p.a2, i0, 0);
+        GemmOperand b2 = operand_at(p.b2, 0, j0);
+
+        if (i0 != j0) {
+            float *c = p.C + (size_t)i0 * p.ldc + j0;
+            gemm_block(kernel, m, n, p.K, p.alpha, a, b, p.beta, c, p.ldc);
+            if (p.rank2) {
+                gemm_block(kernel, m, n, p.K, p.alpha, a2, b2, 1.0f, c,
+                           p.ldc);
+            }
+            return;
+        }
+
+        thread_local AlignedBuffer scratch;
+        float *t = scratch.reserve((size_t)m * m);
+        gemm_block(kernel, m, m, p.K, p.alpha, a, b, 0.0f, t, m);
+        if (p.rank2) {
+            gemm_block(kernel, m, m, p.K, p.alpha, a2, b2, 1.0f, t, m);
+        }
+
+        for (int i = 0; i < m; ++i) {
+            int c0, c1;
+            triangle_row(p.lower, m, i, c0, c1);
+            float *row = p.C + (size_t)(i0 + i) * p.ldc + j0;
+            const float *src = t + (size_t)i * m;
+            if (p.beta == 0.0f) {
+                for (int j = c0; j < c1; ++j) {
+                    row[j] = src[j];
+                }
+            } else {
+                for (int j = c0; j < c1; ++j) {
+                    row[j] = src[j] + p.beta * row[j];
+                }
+            }
+        }
+    };
+
+    if (!parallel) {
+        for (int tile = 0; tile < (int)tiles.size(); ++tile) {
+            run_tile(tile);
+        }
+        return;
+    }
+    scheduler.parallelFor((int)tiles.size(),
+                          [&](int tile, int) { run_tile(tile); });
+}
+
+bool is_transposed(char trans) {
+    switch (trans) {
+    case 'N':
+    case 'n':
+        return false;
+    case 'T':
+    case 't':
+    case 'C':
+    case 'c':
+        return true;
+    default:
+        throw std::invalid_argument("Transpose flag must be 'N', 'T' or 'C'");
+    }
+}
+
+GemmSchedule schedule_from_env() {
+    const char *env = std::getenv("HOST_GEMM_SCHEDULE");
+
+    if (env && !std::strcmp(env, "tiled")) {
+        return GemmSchedule::Tiled;
+    }
+    if (env && !std::strcmp(env, "splitk")) {
+        return GemmSchedule::SplitK;
+    }
+    if (env && !std::strcmp(env, "streamk")) {
+        return GemmSchedule::StreamK;
+    }
+    return GemmSchedule::Auto;
+}
+
+std::atomic<GemmSchedule> &schedule_setting() {
+    static std::atomic<GemmSchedule> schedule(schedule_from_env());
+    return schedule;
+}
+
+// Validates BLAS-style arguments and builds the matching problem
+GemmProblem make_problem(char transA, char transB, int M, int N, int K,
+                         float alpha, const float *A, int lda, const float *B,
+                         int ldb, float beta, float *C, int ldc) {
+    bool ta = is_transposed(transA);
+    bool tb = is_transposed(transB);
+
+    if (M < 0 || N < 0 || K < 0) {
+        throw std::invalid_argument("Matrix dimensions must not be negative");
+    }
+    if (lda < std::max(1, ta ? M : K) || ldb < std::max(1, tb ? K : N) ||
+        ldc < std::max(1, N)) {
+        throw std::invalid_argument(
+            "Leading dimension is smaller than the matrix row");
+    }
+
+    GemmOperand a = ta ? GemmOperand{A, 1, lda} : GemmOperand{A, lda, 1};
+    GemmOperand b = tb ? GemmOperand{B, 1, ldb} : GemmOperand{B, ldb, 1};
+    return {M, N, K, alpha, a, b, beta, C, ldc, GemmEpilogue()};
+}
+
+// make_problem for A and B stored in a 16-bit format
+GemmProblem make_problem(GemmStorage storage, char transA, char transB, int M,
+                         int N, int K, float alpha, const void *A, int lda,
+                         const void *B, int ldb, float beta, float *C,
+                         int ldc) {
+    GemmProblem p = make_problem(transA, transB, M, N, K, alpha, nullptr, lda,
+                                 nullptr, ldb, beta, C, ldc);
+    p.a.storage = storage;
+    p.a.source = A;
+    p.b.storage = storage;
+    p.b.source = B;
+    return p;
+}
+
+// Operand in Mx storage for trans, whose op(mx) is rows x cols
+GemmOperand mx_operand(char trans, const MxMatrix &mx, int &rows, int &cols) {
+    GemmOperand op = {nullptr, 0, 0};
+    op.storage = GemmStorage::Mx;
+    op.source = &mx;
+    op.transposed = is_transposed(trans);
+    rows = op.transposed ? mx.cols : mx.rows;
+    cols = op.transposed ? mx.rows : mx.cols;
+    return op;
+}
+
+bool is_lower(char uplo) {
+    switch (uplo) {
+    case 'L':
+    case 'l':
+        return true;
+    case 'U':
+    case 'u':
+        return false;
+    default:
+        throw std::invalid_argument("Triangle flag must be 'L' or 'U'");
+    }
+}
+
+// Validates the arguments of ssyrk/ssyr2k and builds the update with the
+// given second pair of operands (B for rank-2k, none for rank-k)
+SyrkProblem make_syrk(char uplo, char trans, int N, int K, float alpha,
+                      const float *A, int lda, const float *B, int ldb,
+                      float beta, float *C, int ldc) {
+    bool lower = is_lower(uplo);
+    bool t = is_transposed(trans);
+
+    if (N < 0 || K < 0) {
+        throw std::invalid_argument("Matrix dimensions must not be negative");
+    }
+    int row = std::max(1, t ? N : K);
+    if (lda < row || (B && ldb < row) || ldc < std::max(1, N)) {
+        throw std::invalid_argument(
+            "Leading dimension is smaller than the matrix row");
+    }
+
+    // op(X) is the N x K factor, read with swapped strides as its K x N
+    // transpose for the right hand side
+    auto left = [&](const float *X, int ldx) {
+        return t ? GemmOperand{X, 1, ldx} : GemmOperand{X, ldx, 1};
+    };
+    auto right = [&](const float *X, int ldx) {
+        return t ? GemmOperand{X, ldx, 1} : GemmOperand{X, 1, ldx};
+    };
+
+    SyrkProblem p = {lower, N, K, alpha, left(A, lda), right(A, lda), false,
+                     left(A, lda), right(A, lda), beta, C, ldc};
+    if (B) {
+        p.b = right(B, ldb);
+        p.rank2 = true;
+        p.a2 = left(B, ldb);
+        p.b2 = right(A, lda);
+    }
+    return p;
+}
+
+} // namespace
+
+GemmBlocking host_gemm_blocking() { return gemm_kernel().blocking; }
+
+const char *host_gemm_kernel_name() { return gemm_kernel().name; }
+
+void host_gemm_set_schedule(GemmSchedule schedule) {
+    schedule_setting().store(schedule);
+}
+
+GemmSchedule host_gemm_schedule() { return schedule_setting().load(); }
+
+template <class T>
+void gemm_engine(const typename GemmKernelFor<T>::type &kernel, int M, int N,
+                 int K, T alpha, const GemmStrided<T> &A,
+                 const GemmStrided<T> &B, T beta, T *C, int ldc,
+                 const GemmEpilogueOf<T> &epilogue) {
+    GemmProblemOf<T> p = {M, N, K, alpha, {A.data, A.rs, A.cs},
+                          {B.data, B.rs, B.cs}, beta, C, ldc, epilogue};
+    p.a.conj = A.conj;
+    p.b.conj = B.conj;
+    gemm_driver(kernel, p);
+}
+
+#define GEMM_ENGINE(T)                                                         \
+    template void gemm_engine(const GemmKernelFor<T>::type &, int, int, int,   \
+                              T, const GemmStrided<T> &,                       \
+                              const GemmStrided<T> &, T, T *, int,             \
+                              const GemmEpilogueOf<T> &);
+
+GEMM_ENGINE(double)
+GEMM_ENGINE(std::complex<float>)
+GEMM_ENGINE(std::complex<double>)
+
+template <class T>
+void check_epilogue(const GemmEpilogueOf<T> &epilogue, int N) {
+    if (epilogue.residual && epilogue.ldr < std::max(1, N)) {
+        throw std::invalid_argument(
+            "Leading dimension of the residual is smaller than its row");
+    }
+    if (is_complex_element<T>::value &&
+        epilogue.activation != GemmActivation::None) {
+        throw std::invalid_argument(
+            "Activations are not defined for complex products");
+    }
+}
+
+#define CHECK_EPILOGUE(T)                                                      \
+    template void check_epilogue(const GemmEpilogueOf<T> &, int);
+
+CHECK_EPILOGUE(float)
+CHECK_EPILOGUE(double)
+CHECK_EPILOGUE(std::complex<float>)
+CHECK_EPILOGUE(std::complex<double>)
+
+void sgemm(char transA, char transB, int M, int N, int K, float alpha,
+           const float *A, int lda, const float *B, int ldb, float beta,
+           float *C, int ldc) {
+    gemm_driver(make_problem(transA, transB, M, N, K, alpha, A, lda, B, ldb,
+                             beta, C, ldc));
+}
+
+void sgemm_epilogue(char transA, char transB, int M, int N, int K, float alpha,
+                    const float *A, int lda, const float *B, int ldb,
+                    float beta, float *C, int ldc,
+                    const GemmEpilogue &epilogue) {
+    GemmProblem p = make_problem(transA, transB, M, N, K, alpha, A, lda, B,
+                                 ldb, beta, C, ldc);
+    check_epilogue(epilogue, N);
+    p.epilogue = epilogue;
+    gemm_driver(p);
+}
+
+void sgemm_f16(char transA, char transB, int M, int N, int K, float alpha,
+               const float16 *A, int lda, const float16 *B, int ldb,
+               float beta, float *C, int ldc) {
+    gemm_driver(make_problem(GemmStorage::Float16, transA, transB, M, N, K,
+                             alpha, A, lda, B, ldb, beta, C, ldc));
+}
+
+void sgemm_bf16(char transA, char transB, int M, int N, int K, float alpha,
+                const bfloat16 *A, int lda, const bfloat16 *B, int ldb,
+                float beta, float *C, int ldc) {
+    gemm_driver(make_problem(GemmStorage::BFloat16, transA, transB, M, N, K,
+                             alpha, A, lda, B, ldb, beta, C, ldc));
+}
+
+void sgemm_strided_batched(char transA, char transB, int M, int N, int K,
+                           float alpha, const float *A, int lda,
+                           ptrdiff_t strideA, const float *B, int ldb,
+                           ptrdiff_t strideB, float beta, float *C, int ldc,
+                           ptrdiff_t strideC, int batch) {
+    GemmProblem first = make_problem(transA, transB, M, N, K, alpha, A, lda,
+                                     B, ldb, beta, C, ldc);
+
+    if (batch < 0) {
+        throw std::invalid_argument("Batch count must not be negative");
+    }
+    if (batch > 1 && M > 0 && N > 0 &&
+        std::abs(strideC) < (ptrdiff_t)(M - 1) * ldc + N) {
+        throw std::invalid_argument(
+            "Batch stride of C makes the outputs overlap");
+    }
+
+    gemm_batched_driver(first, strideA, strideB, strideC, batch);
+}
+
+void sgemm_grouped(const GemmDescriptor *problems, int count) {
+    if (count < 0) {
+        throw std::invalid_argument("Group size must not be negative");
+    }
+
+    std::vector<GemmProblem> group;
+    group.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        const GemmDescriptor &d = problems[i];
+        group.push_back(make_problem(d.transA, d.transB, d.M, d.N, d.K,
+                                     d.alpha, d.A, d.lda, d.B, d.ldb, d.beta,
+                                     d.C, d.ldc));
+    }
+
+    gemm_grouped_driver(group);
+}
+
+std::shared_ptr<const PackedMatrixB> sgemm_pack_b(char transB, int K, int N,
+                                                   const float *B, int ldb) {
+    // Validate B as sgemm would, with a dummy single row A and C
+    GemmProblem p = make_problem('N', transB, 1, N, K, 1.0f, nullptr,
+                                 std::max(1, K), B, ldb, 0.0f, nullptr,
+                                 std::max(1, N));
+
+    const GemmBlocking &blk = gemm_kernel().blocking;
+    auto packed = std::make_shared<PackedMatrixB>();
+    packed->K = K;
+    packed->N = N;
+    packed->n_pad = round_up(N, blk.nr);
+    packed->blocking = blk;
+    float *dst = packed->storage.reserve(
+        std::max<size_t>(1, (size_t)K * packed->n_pad));
+
+    int blocks = ceil_div(K, blk.kc);
+    WorkStealingScheduler::instance().parallelFor(blocks, [&](int block,
+                                                              int) {
+        int pc = block * blk.kc;
+        int kc = std::min(blk.kc, K - pc);
+        GemmOperand panel = operand_at(p.b, pc, 0);
+        gemm_pack_b(blk.nr, kc, N, panel.data, panel.rs, panel.cs,
+                    dst + (size_t)pc * packed->n_pad);
+    });
+
+    return packed;
+}
+
+int packed_b_rows(const PackedMatrixB &packedB) { return packedB.K; }
+
+int packed_b_cols(const PackedMatrixB &packedB) { return packedB.N; }
+
+void sgemm_packed(char transA, int M, float alpha, const float *A, int lda,
+                  const PackedMatrixB &packedB, float beta, float *C,
+                  int ldc) {
+    sgemm_packed(transA, M, alpha, A, lda, packedB, beta, C, ldc,
+                 GemmEpilogue());
+}
+
+void sgemm_packed(char transA, int M, float alpha, const float *A, int lda,
+                  const PackedMatrixB &packedB, float beta, float *C, int ldc,
+                  const GemmEpilogue &epilogue) {
+    const GemmBlocking &blk = gemm_kernel().blocking;
+    if (packedB.blocking.nr != blk.nr || packedB.blocking.kc != blk.kc) {
+        throw std::invalid_argument(
+            "Packed B was packed for a different micro-kernel");
+    }
+
+    GemmProblem p = make_problem(transA, 'N', M, packedB.N, packedB.K, alpha,
+                                 A, lda, nullptr, std::max(1, packedB.N),
+                                 beta, C, ldc);
+    check_epilogue(epilogue, packedB.N);
+    p.b = {nullptr, 0, 0, &packedB};
+    p.epilogue = epilogue;
+    gemm_driver(p);
+}
+
+std::shared_ptr<const Int4MatrixB> int4_pack_b(char transB, int K, int N,
+                                               const float *B, int ldb,
+                                               int groupSize) {
+    // Validate B as sgemm would, with a dummy single row A and C
+    GemmProblem p = make_problem('N', transB, 1, N, K, 1.0f, nullptr,
+                                 std::max(1, K), B, ldb, 0.0f, nullptr,
+                                 std::max(1, N));
+    if (groupSize < 1) {
+        throw std::invalid_argument("Group size must be positive");
+    }
+
+    auto packed = std::make_shared<Int4MatrixB>();
+    packed->K = K;
+    packed->N = N;
+    packed->group_size = groupSize;
+    packed->row_bytes = ceil_div(N, INT4_BLOCK) * (INT4_BLOCK / 2);
+    int groups = ceil_div(K, groupSize);
+    packed->nibbles.assign((size_t)K * packed->row_bytes, 0);
+    packed->scales.assign((size_t)groups * N, 1.0f);
+    packed->zeros.assign((size_t)groups * N, 0);
+
+    WorkStealingScheduler::instance().parallelFor(groups, [&](int group,
+                                                              int) {
+        int k0 = group * groupSize;
+        int k1 = std::min(K, k0 + groupSize);
+        float *scale = packed->scales.data() + (size_t)group * N;
+        uint8_t *zero = packed->zeros.data() + (size_t)group * N;
+        auto value = [&](int k, int j) {
+            return p.b.data[(ptrdiff_t)k * p.b.rs + (ptrdiff_t)j * p.b.cs];
+        };
+
+        // The range of every column always covers zero, so zero stays
+        // exactly representable and no value is clamped
+        std::vector<float> lo(N, 0.0f), hi(N, 0.0f);
+        for (int k = k0; k < k1; ++k) {
+            for (int j = 0; j < N; ++j) {
+                lo[j] = std::min(lo[j], value(k, j));
+                hi[j] = std::max(hi[j], value(k, j));
+            }
+        }
+        for (int j = 0; j < N; ++j) {
+            if (hi[j] > lo[j]) {
+                scale[j] = (hi[j] - lo[j]) / 15.0f;
+                zero[j] = (uint8_t)std::min(
+                    15.0f, std::max(0.0f, std::nearbyint(-lo[j] / scale[j])));
+            }
+        }
+
+        for (int k = k0; k < k1; ++k) {
+            uint8_t *row =
+                packed->nibbles.data() + (size_t)k * packed->row_bytes;
+            for (int j = 0; j < N; ++j) {
+                float q = std::nearbyint(value(k, j) / scale[j]) + zero[j];
+                int nibble = (int)std::min(15.0f, std::max(0.0f, q));
+                row[Int4MatrixB::byte_of(j)] |=
+                    (uint8_t)(nibble << Int4MatrixB::shift_of(j));
+            }
+        }
+    });
+
+    return packed;
+}
+
+int int4_b_rows(const Int4MatrixB &packedB) { return packedB.K; }
+
+int int4_b_cols(const Int4MatrixB &packedB) { return packedB.N; }
+
+void int4_unpack_b(const Int4MatrixB &packedB, float *B, int ldb) {
+    if (ldb < std::max(1, packedB.N)) {
+        throw std::invalid_argument(
+            "Leading dimension is smaller than the matrix row");
+    }
+    std::vector<float> scale(packedB.N), offset(packedB.N);
+    for (int k = 0; k < packedB.K; ++k) {
+        if (k % packedB.group_size == 0) {
+            int4_group_terms(packedB, k, 0, packedB.N, scale.data(),
+                             offset.data());
+        }
+        dequantize_int4_row(packedB, k, 0, packedB.N, scale.data(),
+                            offset.data(), B + (size_t)k * ldb);
+    }
+}
+
+void sgemm_int4(char transA, int M, float alpha, const float *A, int lda,
+                const Int4MatrixB &packedB, float beta, float *C, int ldc) {
+    sgemm_int4(transA, M, alpha, A, lda, packedB, beta, C, ldc,
+               GemmEpilogue());
+}
+
+void sgemm_int4(char transA, int M, float alpha, const float *A, int lda,
+                const Int4MatrixB &packedB, float beta, float *C, int ldc,
+                const GemmEpilogue &epilogue) {
+    GemmProblem p = make_problem(transA, 'N', M, packedB.N, packedB.K, alpha,
+                                 A, lda, nullptr, std::max(1, packedB.N),
+                                 beta, C, ldc);
+    check_epilogue(epilogue, packedB.N);
+    p.b = {nullptr, 0, 0};
+    p.b.storage = GemmStorage::Int4;
+    p.b.source = &packedB;
+    p.epilogue = epilogue;
+
+    if (M > 0 && M <= STREAM_MAX_M && p.N > 0 && p.K > 0 && alpha != 0.0f) {
+        int4_stream(p);
+        return;
+    }
+    gemm_driver(p);
+}
+
+void sgemm_mx(char transA, char transB, float alpha, const MxMatrix &A,
+              const MxMatrix &B, float beta, float *C, int ldc) {
+    int M, K, Kb, N;
+    GemmOperand a = mx_operand(transA, A, M, K);
+    GemmOperand b = mx_operand(transB, B, Kb, N);
+    if (K != Kb) {
+        throw std::invalid_argument("Inner dimensions of A and B differ");
+    }
+
+    GemmProblem p = make_problem('N', 'N', M, N, K, alpha, nullptr,
+                                 std::max(1, K), nullptr, std::max(1, N),
+                                 beta, C, ldc);
+    p.b = b;
+
+    // A few rows of A are decoded whole and streamed against B like a
+    // float A
+    if (M > 0 && M <= STREAM_MAX_M && N > 0 && K > 0 && alpha != 0.0f) {
+        thread_local AlignedBuffer buffer;
+        float *wide = buffer.reserve((size_t)M * K);
+        // Panels of one lane are the rows of a row-major matrix
+        pack_mx_panels(1, M, K, A, !a.transposed, 0, 0, wide);
+        p.a = {wide, K, 1};
+        mx_stream(p);
+        return;
+    }
+    p.a = a;
+    gemm_driver(p);
+}
+
+void sgemm_mx(char transA, char transB, int M, float alpha, const float *A,
+              int lda, const MxMatrix &B, float beta, float *C, int ldc) {
+    int K, N;
+    GemmOperand b = mx_operand(transB, B, K, N);
+    GemmProblem p = make_problem(transA, 'N', M, N, K, alpha, A, lda, nullptr,
+                                 std::max(1, N), beta, C, ldc);
+    p.b = b;
+
+    if (M > 0 && M <= STREAM_MAX_M && N > 0 && K > 0 && alpha != 0.0f) {
+        mx_stream(p);
+        return;
+    }
+    gemm_driver(p);
+}
+
+void ssyrk(char uplo, char trans, int N, int K, float alpha, const float *A,
+           int lda, float beta, float *C, int ldc) {
+    syrk_driver(make_syrk(uplo, trans, N, K, alpha, A, lda, nullptr, 0, beta,
+                          C, ldc));
+}
+
+void ssyr2k(char uplo, char trans, int N, int K, float alpha, const float *A,
+            int lda, const float *B, int ldb, float beta, float *C,
+            int ldc) {
+    if (!B) {
+        throw std::invalid_argument("ssyr2k needs a B operand");
+    }
+    syrk_driver(
+        make_syrk(uplo, trans, N, K, alpha, A, lda, B, ldb, beta, C, ldc));
+}
+
+void mirror_triangle(char uplo, int N, float *C, int ldc) {
+    bool lower = is_lower(uplo);
+    if (N < 0) {
+        throw std::invalid_argument("Matrix dimensions must not be negative");
+    }
+    if (ldc < std::max(1, N)) {
+        throw std::invalid_argument(
+            "Leading dimension is smaller than the matrix row");
+    }
+
+    // Task bi fills the blocks of block row bi on the unset side of the
+    // diagonal from the transposed blocks of the source triangle
+    int blocks = ceil_div(N, MIRROR_BLOCK);
+    auto mirror_row = [&](int bi) {
+        int i0 = bi * MIRROR_BLOCK;
+        int i1 = std::min(N, i0 + MIRROR_BLOCK);
+        int jb0 = lower ? bi : 0;
+        int jb1 = lower ? blocks : bi + 1;
+        for (int bj = jb0; bj < jb1; ++bj) {
+            int j0 = bj * MIRROR_BLOCK;
+            int j1 = std::min(N, j0 + MIRROR_BLOCK);
+            for (int i = i0; i < i1; ++i) {
+                float *row = C + (size_t)i * ldc;
+                // Destination (i, j) lies on the unset side: j > i for a
+                // lower source, j < i for an upper one
+                int from = lower ? std::max(j0, i + 1) : j0;
+                int to = lower ? j1 : std::min(j1, i);
+                for (int j = from; j < to; ++j) {
+                    row[j] = C[(size_t)j * ldc + i];
+                }
+            }
+        }
+    };
+
+    if ((double)N * N < GEMM_PARALLEL_MIN_WORK / MIRROR_BLOCK) {
+        for (int bi = 0; bi < blocks; ++bi) {
+            mirror_row(bi);
+        }
+        return;
+    }
+    WorkStealingScheduler::instance().parallelFor(
+        blocks, [&](int bi, int) { mirror_row(bi); });
+}
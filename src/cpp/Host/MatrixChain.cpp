@@ -0,0 +1,223 @@
+#include <Host/AlignedBuffer.hpp>
+#include <Host/HostGemm.hpp>
+#include <Host/MatrixChain.hpp>
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+// Optimal parenthesization of a chain with dimensions dims[0 .. count]:
+// matrix i is dims[i] x dims[i + 1]. split[i * count + j] is the k where the
+// product of matrices i .. j is cut into (i .. k) * (k + 1 .. j).
+struct ChainOrder {
+    int count;
+    std::vector<double> cost;
+    std::vector<int> split;
+
+    double &costOf(int i, int j) { return cost[i * count + j]; }
+    int &splitOf(int i, int j) { return split[i * count + j]; }
+};
+
+static ChainOrder chain_order(const std::vector<int> &dims) {
+    int n = (int)dims.size() - 1;
+    ChainOrder order{n, std::vector<double>((size_t)n * n, 0.0),
+                     std::vector<int>((size_t)n * n, 0)};
+
+    for (int length = 2; length <= n; ++length) {
+        for (int i = 0; i + length - 1 < n; ++i) {
+            int j = i + length - 1;
+            double best = -1.0;
+            for (int k = i; k < j; ++k) {
+                double cost = order.costOf(i, k) + order.costOf(k + 1, j) +
+                              (double)dims[i] * dims[k + 1] * dims[j + 1];
+                if (best < 0.0 || cost < best) {
+                    best = cost;
+                    order.splitOf(i, j) = k;
+                }
+            }
+            order.costOf(i, j) = best;
+        }
+    }
+    return order;
+}
+
+// Node of the evaluation tree. Leaves are the input matrices; every inner
+// node is one product, computed once both children are available.
+struct ChainNode {
+    int rows;
+    int cols;
+    int left = -1;
+    int right = -1;
+    int height = 0; // 0 for leaves, 1 + the taller child otherwise
+    int slot = -1;  // Workspace buffer of an inner node, -1 for the root
+};
+
+static int build_tree(ChainOrder &order, const ChainMatrix *matrices, int i,
+                      int j, std::vector<ChainNode> &nodes) {
+    ChainNode node;
+    node.rows = matrices[i].rows;
+    node.cols = matrices[j].cols;
+
+    if (i != j) {
+        int k = order.splitOf(i, j);
+        node.left = build_tree(order, matrices, i, k, nodes);
+        node.right = build_tree(order, matrices, k + 1, j, nodes);
+        node.height =
+            1 + std::max(nodes[node.left].height, nodes[node.right].height);
+    }
+
+    nodes.push_back(node);
+    return (int)nodes.size() - 1;
+}
+
+static std::vector<int> chain_dims(const ChainMatrix *matrices, int count) {
+    if (count < 1) {
+        throw std::invalid_argument("A chain needs at least one matrix");
+    }
+
+    std::vector<int> dims(count + 1);
+    for (int i = 0; i < count; ++i) {
+        const ChainMatrix &m = matrices[i];
+        if (m.rows < 0 || m.cols < 0) {
+            throw std::invalid_argument(
+                "Matrix dimensions must not be negative");
+        }
+        if (m.ld < std::max(1, m.cols)) {
+            throw std::invalid_argument(
+                "Leading dimension is smaller than the matrix row");
+        }
+        if (i > 0 && m.rows != matrices[i - 1].cols) {
+            throw std::invalid_argument(
+                "Neighbouring matrices of a chain do not match");
+        }
+        dims[i] = m.rows;
+    }
+    dims[count] = matrices[count - 1].cols;
+    return dims;
+}
+
+double matrix_chain_cost(const ChainMatrix *matrices, int count) {
+    std::vector<int> dims = chain_dims(matrices, count);
+    return chain_order(dims).costOf(0, count - 1);
+}
+
+void matrix_chain_multiply(const ChainMatrix *matrices, int count, float *C,
+                           int ldc) {
+    std::vector<int> dims = chain_dims(matrices, count);
+    if (ldc < std::max(1, dims[count])) {
+        throw std::invalid_argument(
+            "Leading dimension is smaller than the matrix row");
+    }
+
+    if (count == 1) {
+        const ChainMatrix &m = matrices[0];
+        for (int i = 0; i < m.rows; ++i) {
+            std::copy(m.data + (size_t)i * m.ld,
+                      m.data + (size_t)i * m.ld + m.cols,
+                      C + (size_t)i * ldc);
+        }
+        return;
+    }
+
+    ChainOrder order = chain_order(dims);
+    std::vector<ChainNode> nodes;
+    nodes.reserve(2 * count - 1);
+    int root = build_tree(order, matrices, 0, count - 1, nodes);
+    int height = nodes[root].height;
+
+    // Inner nodes by height; every node of one height depends only on
+    // lower ones, so each height is a single group of independent products
+    std::vector<std::vector<int>> levels(height + 1);
+    for (int n = 0; n < (int)nodes.size(); ++n) {
+        if (nodes[n].left >= 0) {
+            levels[nodes[n].height].push_back(n);
+        }
+    }
+
+    // Assign workspace slots level by level: outputs take a free slot, and
+    // the slots of their inputs are released once the level has run
+    std::vector<size_t> slot_sizes;
+    std::vector<int> free_slots;
+    for (int h = 1; h <= height; ++h) {
+        for (int n : levels[h]) {
+            if (n == root) {
+                continue;
+            }
+            size_t size = (size_t)nodes[n].rows * nodes[n].cols;
+            if (free_slots.empty()) {
+                nodes[n].slot = (int)slot_sizes.size();
+                slot_sizes.push_back(size);
+            } else {
+                nodes[n].slot = free_slots.back();
+                free_slots.pop_back();
+                slot_sizes[nodes[n].slot] =
+                    std::max(slot_sizes[nodes[n].slot], size);
+            }
+        }
+        for (int n : levels[h]) {
+            for (int child : {nodes[n].left, nodes[n].right}) {
+                if (nodes[child].slot >= 0) {
+                    free_slots.push_back(nodes[child].slot);
+                }
+            }
+        }
+    }
+
+    thread_local std::vector<AlignedBuffer> workspace;
+    if (workspace.size() < slot_sizes.size()) {
+        workspace.resize(slot_sizes.size());
+    }
+    std::vector<float *> slots(slot_sizes.size());
+    for (size_t s = 0; s < slot_sizes.size(); ++s) {
+        slots[s] = workspace[s].reserve(std::max<size_t>(1, slot_sizes[s]));
+    }
+
+    // build_tree visits the leaves left to right, so the i-th leaf node is
+    // matrices[i]. Leaves are read in place, inner nodes from their slot.
+    std::vector<int> leaf_of(nodes.size(), -1);
+    for (int n = 0, leaf = 0; n < (int)nodes.size(); ++n) {
+        if (nodes[n].left < 0) {
+            leaf_of[n] = leaf++;
+        }
+    }
+
+    std::vector<GemmDescriptor> group;
+    for (int h = 1; h <= height; ++h) {
+        group.clear();
+        for (int n : levels[h]) {
+            const ChainNode &node = nodes[n];
+            GemmDescriptor d = {};
+            d.transA = 'N';
+            d.transB = 'N';
+            d.M = node.rows;
+            d.N = node.cols;
+            d.K = nodes[node.left].cols;
+            d.alpha = 1.0f;
+            d.beta = 0.0f;
+
+            for (int side = 0; side < 2; ++side) {
+                int child = side == 0 ? node.left : node.right;
+                const float *data;
+                int ld;
+                if (leaf_of[child] >= 0) {
+                    data = matrices[leaf_of[child]].data;
+                    ld = matrices[leaf_of[child]].ld;
+                } else {
+                    data = slots[nodes[child].slot];
+                    ld = std::max(1, nodes[child].cols);
+                }
+                (side == 0 ? d.A : d.B) = data;
+                (side == 0 ? d.lda : d.ldb) = ld;
+            }
+
+            if (n == root) {
+                d.C = C;
+                d.ldc = ldc;
+            } else {
+                d.C = slots[node.slot];
+                d.ldc = std::max(1, node.cols);
+            }
+            group.push_back(d);
+        }
+        sgemm_grouped(group.data(), (int)group.size());
+    }
+}
@@ -0,0 +1,366 @@
+#include <Host/CpuFeatures.hpp>
+#include <Host/HalfPrecision.hpp>
+#include <Host/Microscaling.hpp>
+#include <Host/WorkStealingScheduler.hpp>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define MICROSCALING_X86
+#endif
+
+// Rows per scheduler task of mx_encode and mx_decode
+constexpr int MX_ROWS_PER_TASK = 16;
+
+// Largest element magnitude, as a power of two, per element type: MXINT8
+// reaches 127/64 < 2^1 and E4M3 448 < 2^9
+constexpr int MX_INT8_EMAX = 0;
+constexpr int MX_FP8_EMAX = 8;
+
+constexpr float MX_FP8_MAX = 448.0f;
+
+// 2^e for e in [-149, 127]
+static inline float exp2i(int e) {
+    if (e >= -126) {
+        return bits_float((uint32_t)(e + 127) << 23);
+    }
+    return bits_float(1u << (e + 149));
+}
+
+// Shared exponent of a block whose largest magnitude is amax: the element
+// exponent range is placed right under amax's own exponent
+static inline int mx_shared_exponent(float amax, int emax) {
+    int e = (int)(float_bits(amax) >> 23) - 127;
+    return std::min(127, std::max(-127, e - emax));
+}
+
+static inline uint8_t float_to_mxint8(float x) {
+    float q = std::nearbyint(x * 64.0f);
+    return (uint8_t)(int8_t)std::min(127.0f, std::max(-127.0f, q));
+}
+
+// Round to nearest even, saturating at 448. Normal results keep the top 3
+// mantissa bits of the float after rounding. Below 2^-6 the result is a
+// multiple of 2^-9, which adding 2^14 (whose ulp is 2^-9) rounds to. The
+// whole conversion is integer arithmetic and masks, so it vectorizes.
+static inline uint8_t float_to_fp8(float x) {
+    uint32_t bits = float_bits(x);
+    uint32_t a = std::min(bits & 0x7fffffffu, float_bits(MX_FP8_MAX));
+
+    uint32_t normal = ((a + 0x7ffffu + ((a >> 20) & 1u)) >> 20) - (120u << 3);
+    uint32_t subnormal =
+        float_bits(bits_float(a) + 0x1p14f) - float_bits(0x1p14f);
+    uint32_t is_subnormal = 0u - (uint32_t)(a < float_bits(0x1p-6f));
+    return (uint8_t)((subnormal & is_subnormal) | (normal & ~is_subnormal) |
+                     ((bits >> 24) & 0x80u));
+}
+
+// E4M3 exponent bits move into the float exponent with the bias difference
+// (127 - 7) added. Codes with a zero exponent are decoded with an exponent
+// of one and the implicit bit (2^-6) subtracted again. The selection is a
+// signed mask rather than a multiply by an unsigned flag, which compiles to
+// one compare and two ands per vector.
+static inline float fp8_to_float(uint8_t code) {
+    int32_t m = code & 0x7f;
+    int32_t is_subnormal = -(int32_t)(m < 8);
+    float a = bits_float((uint32_t)((m << 20) + (120 << 23) +
+                                    (is_subnormal & (1 << 23)))) -
+              bits_float((uint32_t)(is_subnormal & (121 << 23)));
+    return bits_float(float_bits(a) | (uint32_t)(code & 0x80) << 24);
+}
+
+// Scale and element loops over one row. Every loop runs over a single block
+// with a fixed scale and no branches, which the compiler vectorizes.
+template <MxElement E>
+static inline __attribute__((always_inline)) void
+mx_encode_row_body(int cols, const float *src, uint8_t *codes,
+                   uint8_t *scales) {
+    int blocks = (cols + MX_BLOCK - 1) / MX_BLOCK;
+
+    for (int b = 0; b < blocks; ++b) {
+        int n = std::min(MX_BLOCK, cols - b * MX_BLOCK);
+        const float *x = src + b * MX_BLOCK;
+        uint8_t *q = codes + b * MX_BLOCK;
+
+        // Magnitudes order like their bit patterns, and an integer maximum
+        // vectorizes where a float one would not
+        uint32_t amax_bits = 0;
+        for (int t = 0; t < n; ++t) {
+            uint32_t a = float_bits(x[t]) & 0x7fffffffu;
+            amax_bits = a > amax_bits ? a : amax_bits;
+        }
+        float amax = bits_float(amax_bits);
+        int shared = mx_shared_exponent(
+            amax, E == MxElement::Int8 ? MX_INT8_EMAX : MX_FP8_EMAX);
+        float inverse = exp2i(-shared);
+        // E4M3 tops out at 448, not 2^9: blocks that would saturate take the
+        // next scale up
+        if (E == MxElement::Fp8E4M3 && amax * inverse > MX_FP8_MAX &&
+            shared < 127) {
+            ++shared;
+            inverse *= 0.5f;
+        }
+        scales[b] = (uint8_t)(shared + 127);
+
+        for (int t = 0; t < n; ++t) {
+            q[t] = E == MxElement::Int8 ? float_to_mxint8(x[t] * inverse)
+                                        : float_to_fp8(x[t] * inverse);
+        }
+        std::fill(q + n, q + MX_BLOCK, 0);
+    }
+}
+
+// Decodes n codes of one block with the block's scale factor (X, or X / 64
+// for MXINT8)
+template <MxElement E>
+static inline __attribute__((always_inline)) void
+mx_decode_run(const uint8_t *q, int n, float factor, float *dst) {
+    for (int t = 0; t < n; ++t) {
+        float x = E == MxElement::Int8 ? (float)(int8_t)q[t]
+                                       : fp8_to_float(q[t]);
+        dst[t] = x * factor;
+    }
+}
+
+template <MxElement E>
+static inline __attribute__((always_inline)) void
+mx_decode_row_body(const MxMatrix &mx, int r, int col, int n, float *dst) {
+    const uint8_t *codes = mx.row_elements(r);
+    const uint8_t *scales = mx.row_scales(r);
+    const int bias = E == MxElement::Int8 ? 127 + 6 : 127;
+    int end = col + n;
+
+    while (col < end) {
+        int b = col / MX_BLOCK;
+        int stop = std::min(end, (b + 1) * MX_BLOCK);
+        float factor = exp2i(scales[b] - bias);
+
+        // Whole blocks get a fixed trip count, which the compiler turns
+        // into straight vector code
+        if (stop - col == MX_BLOCK) {
+            mx_decode_run<E>(codes + col, MX_BLOCK, factor, dst);
+        } else {
+            mx_decode_run<E>(codes + col, stop - col, factor, dst);
+        }
+        dst += stop - col;
+        col = stop;
+    }
+}
+
+// Rows of A per pass of mx_dot_row_body; each pass decodes the row of the
+// MxMatrix once and keeps a block's worth of accumulators per row of A
+constexpr int MX_DOT_ROWS = 4;
+
+// acc[i][t] += A(i, t) * X(t) over a run of n <= MX_BLOCK codes sharing
+// one scale. Each element is decoded and used in the same iteration: a
+// decoded block stored to the stack and reloaded at another vector width
+// would stall store forwarding on every block.
+template <MxElement E, int ROWS>
+static inline __attribute__((always_inline)) void
+mx_dot_run(const uint8_t *q, int n, float factor, const float *A, int lda,
+           float (*acc)[MX_BLOCK]) {
+    for (int t = 0; t < n; ++t) {
+        float x = (E == MxElement::Int8 ? (float)(int8_t)q[t]
+                                        : fp8_to_float(q[t])) *
+                  factor;
+        for (int i = 0; i < ROWS; ++i) {
+            acc[i][t] += A[(size_t)i * lda + t] * x;
+        }
+    }
+}
+
+// out[i] = sum_k A(i, k) * X(r, k) for ROWS rows of A, a block at a time
+template <MxElement E, int ROWS>
+static inline __attribute__((always_inline)) void
+mx_dot_rows(const MxMatrix &mx, int r, const float *A, int lda, float *out) {
+    const uint8_t *codes = mx.row_elements(r);
+    const uint8_t *scales = mx.row_scales(r);
+    const int bias = E == MxElement::Int8 ? 127 + 6 : 127;
+    const int whole = mx.cols / MX_BLOCK;
+    const int tail = mx.cols - whole * MX_BLOCK;
+    float acc[ROWS][MX_BLOCK] = {};
+
+    for (int b = 0; b < whole; ++b) {
+        mx_dot_run<E, ROWS>(codes + b * MX_BLOCK, MX_BLOCK,
+                            exp2i(scales[b] - bias), A + b * MX_BLOCK, lda,
+                            acc);
+    }
+    if (tail) {
+        mx_dot_run<E, ROWS>(codes + whole * MX_BLOCK, tail,
+                            exp2i(scales[whole] - bias), A + whole * MX_BLOCK,
+                            lda, acc);
+    }
+
+    for (int i = 0; i < ROWS; ++i) {
+        float sum = 0.0f;
+        for (int t = 0; t < MX_BLOCK; ++t) {
+            sum += acc[i][t];
+        }
+        out[i] = sum;
+    }
+}
+
+template <MxElement E>
+static inline __attribute__((always_inline)) void
+mx_dot_row_body(const MxMatrix &mx, int r, int m, const float *A, int lda,
+                float *out) {
+    for (int i = 0; i < m; i += MX_DOT_ROWS) {
+        const float *a = A + (size_t)i * lda;
+        switch (std::min(MX_DOT_ROWS, m - i)) {
+        case 1:
+            mx_dot_rows<E, 1>(mx, r, a, lda, out + i);
+            break;
+        case 2:
+            mx_dot_rows<E, 2>(mx, r, a, lda, out + i);
+            break;
+        case 3:
+            mx_dot_rows<E, 3>(mx, r, a, lda, out + i);
+            break;
+        default:
+            mx_dot_rows<E, MX_DOT_ROWS>(mx, r, a, lda, out + i);
+            break;
+        }
+    }
+}
+
+typedef void (*MxEncodeRow)(MxElement element, int cols, const float *src,
+                            uint8_t *codes, uint8_t *scales);
+typedef void (*MxDecodeRow)(const MxMatrix &mx, int r, int col, int n,
+                            float *dst);
+typedef void (*MxDotRow)(const MxMatrix &mx, int r, int m, const float *A,
+                         int lda, float *out);
+
+#define MX_KERNELS(SUFFIX, TARGET)                                             \
+    TARGET static void mx_encode_row_##SUFFIX(MxElement element, int cols,     \
+                                              const float *src,                \
+                                              uint8_t *codes,                  \
+                                              uint8_t *scales) {               \
+        if (element == MxElement::Int8) {                                      \
+            mx_encode_row_body<MxElement::Int8>(cols, src, codes, scales);     \
+        } else {                                                               \
+            mx_encode_row_body<MxElement::Fp8E4M3>(cols, src, codes, scales);  \
+        }                                                                      \
+    }                                                                          \
+    TARGET static void mx_decode_row_##SUFFIX(const MxMatrix &mx, int r,       \
+                                              int col, int n, float *dst) {    \
+        if (mx.element == MxElement::Int8) {                                   \
+            mx_decode_row_body<MxElement::Int8>(mx, r, col, n, dst);           \
+        } else {                                                               \
+            mx_decode_row_body<MxElement::Fp8E4M3>(mx, r, col, n, dst);        \
+        }                                                                      \
+    }                                                                          \
+    TARGET static void mx_dot_row_##SUFFIX(const MxMatrix &mx, int r, int m,   \
+                                           const float *A, int lda,            \
+                                           float *out) {                       \
+        if (mx.element == MxElement::Int8) {                                   \
+            mx_dot_row_body<MxElement::Int8>(mx, r, m, A, lda, out);           \
+        } else {                                                               \
+            mx_dot_row_body<MxElement::Fp8E4M3>(mx, r, m, A, lda, out);        \
+        }                                                                      \
+    }
+
+MX_KERNELS(generic, )
+
+#ifdef MICROSCALING_X86
+MX_KERNELS(avx2, __attribute__((target("avx2,fma"))))
+MX_KERNELS(avx512, __attribute__((target("avx512f"))))
+#endif
+
+struct MxKernels {
+    MxEncodeRow encodeRow = mx_encode_row_generic;
+    MxDecodeRow decodeRow = mx_decode_row_generic;
+    MxDotRow dotRow = mx_dot_row_generic;
+};
+
+static MxKernels select_mx_kernels() {
+    MxKernels kernels;
+#ifdef MICROSCALING_X86
+    const CpuFeatures &cpu = cpu_features();
+    if (cpu.avx512f) {
+        kernels.encodeRow = mx_encode_row_avx512;
+        kernels.decodeRow = mx_decode_row_avx512;
+        kernels.dotRow = mx_dot_row_avx512;
+    } else if (cpu.avx2 && cpu.fma) {
+        kernels.encodeRow = mx_encode_row_avx2;
+        kernels.decodeRow = mx_decode_row_avx2;
+        kernels.dotRow = mx_dot_row_avx2;
+    }
+#endif
+    return kernels;
+}
+
+static const MxKernels &mx_kernels() {
+    static const MxKernels kernels = select_mx_kernels();
+    return kernels;
+}
+
+// Runs fn(r) for every row, MX_ROWS_PER_TASK rows per scheduler task
+template <class Fn> static void for_each_row(int rows, Fn fn) {
+    int tasks = (rows + MX_ROWS_PER_TASK - 1) / MX_ROWS_PER_TASK;
+    auto run = [&](int task, int) {
+        int r1 = std::min(rows, (task + 1) * MX_ROWS_PER_TASK);
+        for (int r = task * MX_ROWS_PER_TASK; r < r1; ++r) {
+            fn(r);
+        }
+    };
+    if (tasks <= 1) {
+        for (int task = 0; task < tasks; ++task) {
+            run(task, 0);
+        }
+        return;
+    }
+    WorkStealingScheduler::instance().parallelFor(tasks, run);
+}
+
+std::shared_ptr<const MxMatrix> mx_encode(MxElement element, int rows,
+                                          int cols, const float *X, int ldx) {
+    if (rows < 0 || cols < 0) {
+        throw std::invalid_argument("Matrix dimensions must not be negative");
+    }
+    if (ldx < std::max(1, cols)) {
+        throw std::invalid_argument(
+            "Leading dimension is smaller than the matrix row");
+    }
+    if (element != MxElement::Int8 && element != MxElement::Fp8E4M3) {
+        throw std::invalid_argument("Unknown MX element type");
+    }
+
+    auto mx = std::make_shared<MxMatrix>();
+    mx->rows = rows;
+    mx->cols = cols;
+    mx->element = element;
+    mx->blocks_per_row = (cols + MX_BLOCK - 1) / MX_BLOCK;
+    mx->elements.resize((size_t)rows * mx->blocks_per_row * MX_BLOCK);
+    mx->scales.resize((size_t)rows * mx->blocks_per_row);
+
+    MxEncodeRow encode = mx_kernels().encodeRow;
+    MxMatrix &out = *mx;
+    for_each_row(rows, [&](int r) {
+        encode(element, cols, X + (size_t)r * ldx,
+               out.elements.data() + (size_t)r * out.blocks_per_row * MX_BLOCK,
+               out.scales.data() + (size_t)r * out.blocks_per_row);
+    });
+    return mx;
+}
+
+void mx_decode(const MxMatrix &mx, float *X, int ldx) {
+    if (ldx < std::max(1, mx.cols)) {
+        throw std::invalid_argument(
+            "Leading dimension is smaller than the matrix row");
+    }
+
+    MxDecodeRow decode = mx_kernels().decodeRow;
+    for_each_row(mx.rows, [&](int r) {
+        decode(mx, r, 0, mx.cols, X + (size_t)r * ldx);
+    });
+}
+
+void mx_decode_row(const MxMatrix &mx, int r, int col, int n, float *dst) {
+    mx_kernels().decodeRow(mx, r, col, n, dst);
+}
+
+void mx_dot_row(const MxMatrix &mx, int r, int m, const float *A, int lda,
+                float *out) {
+    mx_kernels().dotRow(mx, r, m, A, lda, out);
+}
@@ -0,0 +1,592 @@
+#include <Host/AlignedBuffer.hpp>
+#include <Host/CpuFeatures.hpp>
+#include <Host/QuantizedGemm.hpp>
+#include <Host/WorkStealingScheduler.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define QGEMM_X86
+#include <immintrin.h>
+#endif
+
+// Register tile: 8 rows of 32 int32 sums, two zmm registers per row for the
+// VNNI kernel
+constexpr int QGEMM_MR = 8;
+constexpr int QGEMM_NR = 32;
+
+// Largest tile of C per scheduler task; its packed A rows (MC x K bytes)
+// stay in L2 while every panel of B in the tile streams past them
+constexpr int QGEMM_MC = 96;
+constexpr int QGEMM_NC = 512;
+
+constexpr int QGEMM_MAX_K = 65536;
+
+// Problems below this many multiply-adds stay on the calling thread
+constexpr double QGEMM_PARALLEL_MIN_WORK = 64.0 * 64.0 * 64.0;
+
+constexpr int QGEMM_TILES_PER_WORKER = 4;
+
+// Computes one QGEMM_MR x QGEMM_NR tile of unsigned A times signed B sums
+// over k4 groups of four k into acc (row stride QGEMM_NR, 64 byte aligned)
+typedef void (*QgemmMicroKernel)(int k4, const uint8_t *a, const int8_t *b,
+                                 int32_t *acc);
+
+struct QgemmKernel {
+    const char *name;
+    QgemmMicroKernel fn;
+};
+
+static inline __attribute__((always_inline)) void
+qgemm_ukernel_body(int k4, const uint8_t *a, const int8_t *b, int32_t *acc) {
+    int32_t c[QGEMM_MR][QGEMM_NR] = {};
+
+    for (int g = 0; g < k4; ++g) {
+        for (int i = 0; i < QGEMM_MR; ++i) {
+            int32_t a0 = a[i * 4];
+            int32_t a1 = a[i * 4 + 1];
+            int32_t a2 = a[i * 4 + 2];
+            int32_t a3 = a[i * 4 + 3];
+            for (int j = 0; j < QGEMM_NR; ++j) {
+                const int8_t *bj = b + j * 4;
+                c[i][j] += a0 * bj[0] + a1 * bj[1] + a2 * bj[2] + a3 * bj[3];
+            }
+        }
+        a += QGEMM_MR * 4;
+        b += QGEMM_NR * 4;
+    }
+
+    std::memcpy(acc, c, sizeof(c));
+}
+
+static void qgemm_ukernel_generic(int k4, const uint8_t *a, const int8_t *b,
+                                  int32_t *acc) {
+    qgemm_ukernel_body(k4, a, b, acc);
+}
+
+#ifdef QGEMM_X86
+
+__attribute__((target("avx2"))) static void
+qgemm_ukernel_avx2(int k4, const uint8_t *a, const int8_t *b, int32_t *acc) {
+    qgemm_ukernel_body(k4, a, b, acc);
+}
+
+// One vpdpbusd per 16 columns: every int32 lane of a column vector holds
+// the four k bytes of one column, multiplied with the four broadcast bytes
+// of a row of A and summed into that lane
+__attribute__((target("avx512f,avx512vnni"))) static void
+qgemm_ukernel_vnni(int k4, const uint8_t *a, const int8_t *b, int32_t *acc) {
+    __m512i c[QGEMM_MR][2];
+    for (int i = 0; i < QGEMM_MR; ++i) {
+        c[i][0] = _mm512_setzero_si512();
+        c[i][1] = _mm512_setzero_si512();
+    }
+
+    for (int g = 0; g < k4; ++g) {
+        __m512i b0 = _mm512_load_si512(b);
+        __m512i b1 = _mm512_load_si512(b + 64);
+        for (int i = 0; i < QGEMM_MR; ++i) {
+            int32_t quad;
+            std::memcpy(&quad, a + i * 4, sizeof(quad));
+            __m512i ai = _mm512_set1_epi32(quad);
+            c[i][0] = _mm512_dpbusd_epi32(c[i][0], ai, b0);
+            c[i][1] = _mm512_dpbusd_epi32(c[i][1], ai, b1);
+        }
+        a += QGEMM_MR * 4;
+        b += QGEMM_NR * 4;
+    }
+
+    for (int i = 0; i < QGEMM_MR; ++i) {
+        _mm512_store_si512(acc + i * QGEMM_NR, c[i][0]);
+        _mm512_store_si512(acc + i * QGEMM_NR + 16, c[i][1]);
+    }
+}
+
+#endif
+
+static const QgemmKernel &select_qgemm_kernel() {
+    static const QgemmKernel generic = {"generic", qgemm_ukernel_generic};
+#ifdef QGEMM_X86
+    static const QgemmKernel avx2 = {"avx2", qgemm_ukernel_avx2};
+    static const QgemmKernel vnni = {"avx512vnni", qgemm_ukernel_vnni};
+
+    const CpuFeatures &cpu = cpu_features();
+    if (cpu.avx512vnni) {
+        return vnni;
+    }
+    if (cpu.avx2) {
+        return avx2;
+    }
+#endif
+    return generic;
+}
+
+static const QgemmKernel &qgemm_kernel() {
+    static const QgemmKernel &kernel = select_qgemm_kernel();
+    return kernel;
+}
+
+// B packed by int8_pack_b in the layout of qgemm_pack_b, with the column
+// sums the correction of every product is derived from
+class Int8MatrixB {
+  public:
+    int K;
+    int N;
+    int k4;    // K rounded up to whole groups of four, in groups
+    int n_pad; // N rounded up to whole panels
+    AlignedBuffer storage;
+    std::vector<int32_t> column_sums; // n_pad entries
+
+    const int8_t *panels() const {
+        return reinterpret_cast<const int8_t *>(storage.data());
+    }
+};
+
+// Validated arguments of a quantized product. Element (i, k) of op(A) is
+// A[i * a_rs + k * a_cs] and element (k, j) of op(B) is B[k * b_rs + j * b_cs],
+// unless B is pre-packed.
+struct QgemmProblem {
+    int M;
+    int N;
+    int K;
+    const int8_t *A;
+    ptrdiff_t a_rs;
+    ptrdiff_t a_cs;
+    int zeroA;
+    const int8_t *B;
+    ptrdiff_t b_rs;
+    ptrdiff_t b_cs;
+    const Int8MatrixB *packed = nullptr;
+};
+
+static bool qgemm_transposed(char trans) {
+    switch (trans) {
+    case 'N':
+    case 'n':
+        return false;
+    case 'T':
+    case 't':
+        return true;
+    default:
+        throw std::invalid_argument("Transpose flag must be 'N' or 'T'");
+    }
+}
+
+static QgemmProblem make_qgemm(char transA, char transB, int M, int N, int K,
+                               const int8_t *A, int lda, int zeroA,
+                               const int8_t *B, int ldb, int ldc) {
+    bool ta = qgemm_transposed(transA);
+    bool tb = qgemm_transposed(transB);
+
+    if (M < 0 || N < 0 || K < 0) {
+        throw std::invalid_argument("Matrix dimensions must not be negative");
+    }
+    if (K > QGEMM_MAX_K) {
+        throw std::invalid_argument(
+            "K is too large for exact int32 accumulation");
+    }
+    if (lda < std::max(1, ta ? M : K) || ldb < std::max(1, tb ? K : N) ||
+        ldc < std::max(1, N)) {
+        throw std::invalid_argument(
+            "Leading dimension is smaller than the matrix row");
+    }
+    if (zeroA < -128 || zeroA > 127) {
+        throw std::invalid_argument("Zero point is outside the int8 range");
+    }
+
+    QgemmProblem p = {M, N, K, A, ta ? 1 : lda, ta ? lda : 1, zeroA,
+                      B, tb ? 1 : ldb, tb ? ldb : 1};
+    return p;
+}
+
+// Packs op(B) into QGEMM_NR wide panels of k4 groups: byte t of column j
+// of group g is at panel[(g * QGEMM_NR + j) * 4 + t]. Columns past N and k
+// past K are zero. column_sums[j] receives the sum of column j.
+static void qgemm_pack_b(const QgemmProblem &p, int k4, int n_pad,
+                         int8_t *dst, int32_t *column_sums) {
+    for (int jr = 0; jr < n_pad; jr += QGEMM_NR) {
+        int nr = std::max(0, std::min(QGEMM_NR, p.N - jr));
+        int32_t sums[QGEMM_NR] = {};
+        int8_t *panel = dst + (size_t)jr * k4 * 4;
+
+        for (int g = 0; g < k4; ++g) {
+            // Whole groups of contiguous rows interleave in one pass
+            if (nr == QGEMM_NR && p.b_cs == 1 && g * 4 + 4 <= p.K) {
+                const int8_t *r0 = p.B + g * 4 * p.b_rs + jr;
+                const int8_t *r1 = r0 + p.b_rs;
+                const int8_t *r2 = r1 + p.b_rs;
+                const int8_t *r3 = r2 + p.b_rs;
+                int8_t *out = panel + g * QGEMM_NR * 4;
+                for (int j = 0; j < QGEMM_NR; ++j) {
+                    out[j * 4] = r0[j];
+                    out[j * 4 + 1] = r1[j];
+                    out[j * 4 + 2] = r2[j];
+                    out[j * 4 + 3] = r3[j];
+                    sums[j] += r0[j] + r1[j] + r2[j] + r3[j];
+                }
+                continue;
+            }
+
+            for (int t = 0; t < 4; ++t) {
+                int k = g * 4 + t;
+                int8_t *out = panel + g * QGEMM_NR * 4 + t;
+                int j = 0;
+                if (k < p.K) {
+                    const int8_t *row = p.B + k * p.b_rs + jr * p.b_cs;
+                    for (; j < nr; ++j) {
+                        out[j * 4] = row[j * p.b_cs];
+                        sums[j] += row[j * p.b_cs];
+                    }
+                }
+                for (; j < QGEMM_NR; ++j) {
+                    out[j * 4] = 0;
+                }
+            }
+        }
+
+        std::copy(sums, sums + QGEMM_NR, column_sums + jr);
+    }
+}
+
+// Packs rows [i0, i0 + m) of op(A) into QGEMM_MR row panels of k4 groups,
+// offset by 128 into unsigned bytes. Rows past m and k past K are zero.
+static void qgemm_pack_a(const QgemmProblem &p, int i0, int m, int k4,
+                         uint8_t *dst) {
+    for (int ir = 0; ir < m; ir += QGEMM_MR) {
+        int mr = std::min(QGEMM_MR, m - ir);
+        uint8_t *panel = dst + (size_t)ir * k4 * 4;
+
+        for (int g = 0; g < k4; ++g) {
+            uint8_t *out = panel + g * QGEMM_MR * 4;
+            for (int i = 0; i < QGEMM_MR; ++i) {
+                for (int t = 0; t < 4; ++t) {
+                    int k = g * 4 + t;
+                    out[i * 4 + t] = 0;
+                    if (i < mr && k < p.K) {
+                        int8_t v = p.A[(i0 + ir + i) * p.a_rs + k * p.a_cs];
+                        out[i * 4 + t] = (uint8_t)(v + 128);
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Runs the product and hands every finished register tile to
+// store(i, j, m, n, acc, correction): the m x n tile at (i, j) of C as raw
+// sums in acc (row stride QGEMM_NR) and the correction of its columns, to
+// be subtracted from every row
+template <class Store>
+static void qgemm_driver(const QgemmProblem &p, const Store &store) {
+    if (p.M <= 0 || p.N <= 0) {
+        return;
+    }
+
+    const QgemmKernel &kernel = qgemm_kernel();
+    int k4 = (p.K + 3) / 4;
+    int n_pad = (p.N + QGEMM_NR - 1) / QGEMM_NR * QGEMM_NR;
+
+    // (128 + zeroA) * column sum turns sums over the offset A into sums
+    // over A - zeroA
+    std::vector<int32_t> correction(n_pad);
+    const int8_t *packed_b;
+    if (p.packed) {
+        packed_b = p.packed->panels();
+        correction = p.packed->column_sums;
+    } else {
+        thread_local AlignedBuffer buffer_b;
+        int8_t *panels = buffer_b.reserve_as<int8_t>((size_t)k4 * 4 * n_pad);
+        qgemm_pack_b(p, k4, n_pad, panels, correction.data());
+        packed_b = panels;
+    }
+    for (int32_t &c : correction) {
+        c *= 128 + p.zeroA;
+    }
+
+    // Tiles are cut to whole register tiles, and shrunk until every worker
+    // has a few of them
+    WorkStealingScheduler &scheduler = WorkStealingScheduler::instance();
+    bool parallel = scheduler.size() > 1 &&
+                    (double)p.M * p.N * p.K >= QGEMM_PARALLEL_MIN_WORK;
+    int target = parallel ? scheduler.size() * QGEMM_TILES_PER_WORKER : 1;
+
+    int tile_m = std::min(QGEMM_MC, (p.M + QGEMM_MR - 1) / QGEMM_MR * QGEMM_MR);
+    int tile_n = std::min(QGEMM_NC, n_pad);
+    auto tiles = [&]() {
+        return ((p.M + tile_m - 1) / tile_m) * ((p.N + tile_n - 1) / tile_n);
+    };
+    while (tiles() < target && tile_n > QGEMM_NR) {
+        tile_n = std::max(QGEMM_NR, tile_n / 2 / QGEMM_NR * QGEMM_NR);
+    }
+    while (tiles() < target && tile_m > QGEMM_MR) {
+        tile_m = std::max(QGEMM_MR, tile_m / 2 / QGEMM_MR * QGEMM_MR);
+    }
+    int tiles_n = (p.N + tile_n - 1) / tile_n;
+
+    auto run = [&](int tile) {
+        int ic = (tile / tiles_n) * tile_m;
+        int jc = (tile % tiles_n) * tile_n;
+        int mc = std::min(tile_m, p.M - ic);
+        int nc = std::min(tile_n, p.N - jc);
+
+        thread_local AlignedBuffer buffer_a;
+        thread_local AlignedBuffer buffer_acc;
+        int mc_pad = (mc + QGEMM_MR - 1) / QGEMM_MR * QGEMM_MR;
+        uint8_t *packed_a =
+            buffer_a.reserve_as<uint8_t>((size_t)mc_pad * k4 * 4);
+        int32_t *acc =
+            buffer_acc.reserve_as<int32_t>(QGEMM_MR * QGEMM_NR);
+        qgemm_pack_a(p, ic, mc, k4, packed_a);
+
+        for (int jr = 0; jr < nc; jr += QGEMM_NR) {
+            const int8_t *panel = packed_b + (size_t)(jc + jr) * k4 * 4;
+            for (int ir = 0; ir < mc; ir += QGEMM_MR) {
+                kernel.fn(k4, packed_a + (size_t)ir * k4 * 4, panel, acc);
+                store(ic + ir, jc + jr, std::min(QGEMM_MR, mc - ir),
+                      std::min(QGEMM_NR, nc - jr), acc,
+                      correction.data() + jc + jr);
+            }
+        }
+    };
+
+    if (!parallel) {
+        for (int tile = 0; tile < tiles(); ++tile) {
+            run(tile);
+        }
+        return;
+    }
+    scheduler.parallelFor(tiles(), [&](int tile, int) { run(tile); });
+}
+
+// scale[j] of B times the scale of A, for all N columns
+static std::vector<float> combined_scales(const QuantizedGemmScales &scales,
+                                          int N) {
+    if (!scales.b) {
+        throw std::invalid_argument("Scales of B are missing");
+    }
+    std::vector<float> combined(std::max(N, 0));
+    for (int j = 0; j < N; ++j) {
+        combined[j] = scales.a.scale * scales.b[scales.perChannel ? j : 0];
+    }
+    return combined;
+}
+
+static int8_t saturate_int8(float v) {
+    return (int8_t)std::min(127.0f, std::max(-128.0f, v));
+}
+
+QuantParams quantize_tensor(int rows, int cols, const float *X, int ldx,
+                            int8_t *Q, int ldq) {
+    if (rows < 0 || cols < 0) {
+        throw std::invalid_argument("Matrix dimensions must not be negative");
+    }
+    if (ldx < std::max(1, cols) || ldq < std::max(1, cols)) {
+        throw std::invalid_argument(
+            "Leading dimension is smaller than the matrix row");
+    }
+
+    // The range always covers zero so that zero is exactly representable
+    float lo = 0.0f, hi = 0.0f;
+    for (int i = 0; i < rows; ++i) {
+        for (int j = 0; j < cols; ++j) {
+            lo = std::min(lo, X[(size_t)i * ldx + j]);
+            hi = std::max(hi, X[(size_t)i * ldx + j]);
+        }
+    }
+
+    QuantParams q;
+    q.scale = hi > lo ? (hi - lo) / 255.0f : 1.0f;
+    q.zeroPoint = (int)std::min(
+        127.0f, std::max(-128.0f, std::nearbyint(-128.0f - lo / q.scale)));
+
+    for (int i = 0; i < rows; ++i) {
+        for (int j = 0; j < cols; ++j) {
+            float v = std::nearbyint(X[(size_t)i * ldx + j] / q.scale);
+            Q[(size_t)i * ldq + j] = saturate_int8(v + q.zeroPoint);
+        }
+    }
+    return q;
+}
+
+void quantize_columns(int rows, int cols, const float *X, int ldx, int8_t *Q,
+                      int ldq, float *scales) {
+    if (rows < 0 || cols < 0) {
+        throw std::invalid_argument("Matrix dimensions must not be negative");
+    }
+    if (ldx < std::max(1, cols) || ldq < std::max(1, cols)) {
+        throw std::invalid_argument(
+            "Leading dimension is smaller than the matrix row");
+    }
+
+    for (int j = 0; j < cols; ++j) {
+        float amax = 0.0f;
+        for (int i = 0; i < rows; ++i) {
+            amax = std::max(amax, std::fabs(X[(size_t)i * ldx + j]));
+        }
+        scales[j] = amax > 0.0f ? amax / 127.0f : 1.0f;
+    }
+
+    for (int i = 0; i < rows; ++i) {
+        for (int j = 0; j < cols; ++j) {
+            float v = std::nearbyint(X[(size_t)i * ldx + j] / scales[j]);
+            Q[(size_t)i * ldq + j] = saturate_int8(v);
+        }
+    }
+}
+
+// Stores of the three products, shared by the strided and packed B entry
+// points
+
+static void run_s32(const QgemmProblem &p, int32_t *C, int ldc) {
+    qgemm_driver(p, [&](int i, int j, int m, int n, const int32_t *acc,
+                        const int32_t *correction) {
+        for (int r = 0; r < m; ++r) {
+            int32_t *row = C + (size_t)(i + r) * ldc + j;
+            const int32_t *sums = acc + r * QGEMM_NR;
+            for (int c = 0; c < n; ++c) {
+                row[c] = sums[c] - correction[c];
+            }
+        }
+    });
+}
+
+static void run_dequantize(const QgemmProblem &p,
+                           const QuantizedGemmScales &scales,
+                           const float *bias, float *C, int ldc) {
+    std::vector<float> scale = combined_scales(scales, p.N);
+
+    qgemm_driver(p, [&](int i, int j, int m, int n, const int32_t *acc,
+                        const int32_t *correction) {
+        const float *s = scale.data() + j;
+        for (int r = 0; r < m; ++r) {
+            float *row = C + (size_t)(i + r) * ldc + j;
+            const int32_t *sums = acc + r * QGEMM_NR;
+            for (int c = 0; c < n; ++c) {
+                row[c] = (float)(sums[c] - correction[c]) * s[c];
+            }
+            if (bias) {
+                for (int c = 0; c < n; ++c) {
+                    row[c] += bias[j + c];
+                }
+            }
+        }
+    });
+}
+
+static void run_requantize(const QgemmProblem &p,
+                           const QuantizedGemmScales &scales,
+                           const float *bias, QuantParams c, int8_t *C,
+                           int ldc) {
+    if (!(c.scale > 0.0f)) {
+        throw std::invalid_argument("Output scale must be positive");
+    }
+
+    // Everything is divided by the output scale up front, so the store is
+    // one multiply-add, a rounding and a clamp per element
+    std::vector<float> scale = combined_scales(scales, p.N);
+    std::vector<float> offset(std::max(p.N, 0));
+    for (int j = 0; j < p.N; ++j) {
+        scale[j] /= c.scale;
+        offset[j] = bias ? bias[j] / c.scale : 0.0f;
+    }
+
+    float zero = (float)c.zeroPoint;
+
+    qgemm_driver(p, [&](int i, int j, int m, int n, const int32_t *acc,
+                        const int32_t *correction) {
+        const float *s = scale.data() + j;
+        const float *o = offset.data() + j;
+        for (int r = 0; r < m; ++r) {
+            int8_t *row = C + (size_t)(i + r) * ldc + j;
+            const int32_t *sums = acc + r * QGEMM_NR;
+            for (int col = 0; col < n; ++col) {
+                float v = (float)(sums[col] - correction[col]) * s[col];
+                row[col] = saturate_int8(std::nearbyint(v + o[col]) + zero);
+            }
+        }
+    });
+}
+
+// Validates op(A) against a packed B, as sgemm_packed does
+static QgemmProblem make_qgemm(char transA, int M, const int8_t *A, int lda,
+                               int zeroA, const Int8MatrixB &packedB,
+                               int ldc) {
+    QgemmProblem p = make_qgemm(transA, 'N', M, packedB.N, packedB.K, A, lda,
+                                zeroA, nullptr, std::max(1, packedB.N), ldc);
+    p.packed = &packedB;
+    return p;
+}
+
+std::shared_ptr<const Int8MatrixB> int8_pack_b(char transB, int K, int N,
+                                               const int8_t *B, int ldb) {
+    // Validate B as qgemm_s32 would, with a dummy single row A and C
+    QgemmProblem p = make_qgemm('N', transB, 1, N, K, nullptr, std::max(1, K),
+                                0, B, ldb, std::max(1, N));
+
+    auto packed = std::make_shared<Int8MatrixB>();
+    packed->K = K;
+    packed->N = N;
+    packed->k4 = (K + 3) / 4;
+    packed->n_pad = (N + QGEMM_NR - 1) / QGEMM_NR * QGEMM_NR;
+    packed->column_sums.assign(packed->n_pad, 0);
+    int8_t *panels = packed->storage.reserve_as<int8_t>(
+        std::max<size_t>(1, (size_t)packed->k4 * 4 * packed->n_pad));
+    qgemm_pack_b(p, packed->k4, packed->n_pad, panels,
+                 packed->column_sums.data());
+    return packed;
+}
+
+int int8_b_rows(const Int8MatrixB &packedB) { return packedB.K; }
+
+int int8_b_cols(const Int8MatrixB &packedB) { return packedB.N; }
+
+void qgemm_s32(char transA, char transB, int M, int N, int K, const int8_t *A,
+               int lda, int zeroA, const int8_t *B, int ldb, int32_t *C,
+               int ldc) {
+    run_s32(make_qgemm(transA, transB, M, N, K, A, lda, zeroA, B, ldb, ldc),
+            C, ldc);
+}
+
+void qgemm_s32(char transA, int M, const int8_t *A, int lda, int zeroA,
+               const Int8MatrixB &packedB, int32_t *C, int ldc) {
+    run_s32(make_qgemm(transA, M, A, lda, zeroA, packedB, ldc), C, ldc);
+}
+
+void qgemm_dequantize(char transA, char transB, int M, int N, int K,
+                      const int8_t *A, int lda, const int8_t *B, int ldb,
+                      const QuantizedGemmScales &scales, const float *bias,
+                      float *C, int ldc) {
+    run_dequantize(make_qgemm(transA, transB, M, N, K, A, lda,
+                              scales.a.zeroPoint, B, ldb, ldc),
+                   scales, bias, C, ldc);
+}
+
+void qgemm_dequantize(char transA, int M, const int8_t *A, int lda,
+                      const Int8MatrixB &packedB,
+                      const QuantizedGemmScales &scales, const float *bias,
+                      float *C, int ldc) {
+    run_dequantize(
+        make_qgemm(transA, M, A, lda, scales.a.zeroPoint, packedB, ldc),
+        scales, bias, C, ldc);
+}
+
+void qgemm_requantize(char transA, char transB, int M, int N, int K,
+                      const int8_t *A, int lda, const int8_t *B, int ldb,
+                      const QuantizedGemmScales &scales, const float *bias,
+                      QuantParams c, int8_t *C, int ldc) {
+    run_requantize(make_qgemm(transA, transB, M, N, K, A, lda,
+                              scales.a.zeroPoint, B, ldb, ldc),
+                   scales, bias, c, C, ldc);
+}
+
+void qgemm_requantize(char transA, int M, const int8_t *A, int lda,
+                      const Int8MatrixB &packedB,
+                      const QuantizedGemmScales &scales, const float *bias,
+                      QuantParams c, int8_t *C, int ldc) {
+    run_requantize(
+        make_qgemm(transA, M, A, lda, scales.a.zeroPoint, packedB, ldc),
+        scales, bias, c, C, ldc);
+}
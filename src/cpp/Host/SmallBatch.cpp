@@ -0,0 +1,188 @@
+#include <Host/CpuFeatures.hpp>
+#include <Host/SmallBatch.hpp>
+#include <Host/WorkStealingScheduler.hpp>
+#include <algorithm>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SMALL_BATCH_X86
+#endif
+
+// Blocks per scheduler task; a few thousand matrices per task keeps the
+// scheduling cost negligible next to the multiplies
+constexpr size_t AOSOA_BLOCKS_PER_TASK = 256;
+
+typedef void (*AosoaKernel)(const float *a, const float *b, float *c, int M,
+                            int N, int K, size_t begin, size_t end);
+
+// One block with compile-time dimensions. The lane loop is innermost and
+// contiguous, so it becomes one (or a few) vector operations per element
+// once the i/j/k loops are unrolled.
+template <int M, int N, int K>
+static inline __attribute__((always_inline)) void
+aosoa_block(const float *a, const float *b, float *c) {
+    for (int i = 0; i < M; ++i) {
+        for (int j = 0; j < N; ++j) {
+            float acc[AOSOA_LANES] = {};
+            for (int k = 0; k < K; ++k) {
+                const float *ak = a + (i * K + k) * AOSOA_LANES;
+                const float *bk = b + (k * N + j) * AOSOA_LANES;
+                for (int l = 0; l < AOSOA_LANES; ++l) {
+                    acc[l] += ak[l] * bk[l];
+                }
+            }
+            float *cij = c + (i * N + j) * AOSOA_LANES;
+            for (int l = 0; l < AOSOA_LANES; ++l) {
+                cij[l] = acc[l];
+            }
+        }
+    }
+}
+
+// Same loop nest for dimensions only known at runtime
+static inline __attribute__((always_inline)) void
+aosoa_block_any(const float *a, const float *b, float *c, int M, int N,
+                int K) {
+    for (int i = 0; i < M; ++i) {
+        for (int j = 0; j < N; ++j) {
+            float acc[AOSOA_LANES] = {};
+            for (int k = 0; k < K; ++k) {
+                const float *ak = a + (i * K + k) * AOSOA_LANES;
+                const float *bk = b + (k * N + j) * AOSOA_LANES;
+                for (int l = 0; l < AOSOA_LANES; ++l) {
+                    acc[l] += ak[l] * bk[l];
+                }
+            }
+            float *cij = c + (i * N + j) * AOSOA_LANES;
+            for (int l = 0; l < AOSOA_LANES; ++l) {
+                cij[l] = acc[l];
+            }
+        }
+    }
+}
+
+// Kernel bodies shared by every ISA. Each variant below only differs in the
+// target attribute it is compiled with, which decides the vector width the
+// lane loops are vectorized to.
+#define AOSOA_KERNELS(SUFFIX, TARGET)                                          \
+    template <int D>                                                           \
+    TARGET static void aosoa_square_##SUFFIX(const float *a, const float *b,  \
+                                             float *c, int, int, int,          \
+                                             size_t begin, size_t end) {       \
+        const size_t stride = (size_t)D * D * AOSOA_LANES;                     \
+        for (size_t blk = begin; blk < end; ++blk) {                           \
+            aosoa_block<D, D, D>(a + blk * stride, b + blk * stride,           \
+                                 c + blk * stride);                            \
+        }                                                                      \
+    }                                                                          \
+                                                                               \
+    TARGET static void aosoa_any_##SUFFIX(const float *a, const float *b,     \
+                                          float *c, int M, int N, int K,       \
+                                          size_t begin, size_t end) {          \
+        const size_t stride_a = (size_t)M * K * AOSOA_LANES;                   \
+        const size_t stride_b = (size_t)K * N * AOSOA_LANES;                   \
+        const size_t stride_c = (size_t)M * N * AOSOA_LANES;                   \
+        for (size_t blk = begin; blk < end; ++blk) {                           \
+            aosoa_block_any(a + blk * stride_a, b + blk * stride_b,            \
+                            c + blk * stride_c, M, N, K);                      \
+        }                                                                      \
+    }
+
+AOSOA_KERNELS(generic, )
+
+#ifdef SMALL_BATCH_X86
+AOSOA_KERNELS(avx2, __attribute__((target("avx2,fma"))))
+AOSOA_KERNELS(avx512, __attribute__((target("avx512f"))))
+#endif
+
+#define AOSOA_SELECT(SUFFIX, M, N, K)                                          \
+    (M == N && N == K && M == 2)   ? aosoa_square_##SUFFIX<2>                  \
+    : (M == N && N == K && M == 3) ? aosoa_square_##SUFFIX<3>                  \
+    : (M == N && N == K && M == 4) ? aosoa_square_##SUFFIX<4>                  \
+                                   : aosoa_any_##SUFFIX
+
+static AosoaKernel select_aosoa_kernel(int M, int N, int K) {
+#ifdef SMALL_BATCH_X86
+    const CpuFeatures &cpu = cpu_features();
+    if (cpu.avx512f) {
+        return AOSOA_SELECT(avx512, M, N, K);
+    }
+    if (cpu.avx2 && cpu.fma) {
+        return AOSOA_SELECT(avx2, M, N, K);
+    }
+#endif
+    return AOSOA_SELECT(generic, M, N, K);
+}
+
+size_t aosoa_size(int rows, int cols, size_t count) {
+    size_t blocks = (count + AOSOA_LANES - 1) / AOSOA_LANES;
+    return blocks * rows * cols * AOSOA_LANES;
+}
+
+void aosoa_pack(const float *src, int rows, int cols, size_t count,
+                float *dst) {
+    const size_t elems = (size_t)rows * cols;
+    size_t blocks = (count + AOSOA_LANES - 1) / AOSOA_LANES;
+
+    for (size_t blk = 0; blk < blocks; ++blk) {
+        float *block = dst + blk * elems * AOSOA_LANES;
+        size_t first = blk * AOSOA_LANES;
+        int lanes = (int)std::min<size_t>(AOSOA_LANES, count - first);
+
+        for (size_t e = 0; e < elems; ++e) {
+            float *lane = block + e * AOSOA_LANES;
+            int l = 0;
+            for (; l < lanes; ++l) {
+                lane[l] = src[(first + l) * elems + e];
+            }
+            for (; l < AOSOA_LANES; ++l) {
+                lane[l] = 0.0f;
+            }
+        }
+    }
+}
+
+void aosoa_unpack(const float *src, int rows, int cols, size_t count,
+                  float *dst) {
+    const size_t elems = (size_t)rows * cols;
+    size_t blocks = (count + AOSOA_LANES - 1) / AOSOA_LANES;
+
+    for (size_t blk = 0; blk < blocks; ++blk) {
+        const float *block = src + blk * elems * AOSOA_LANES;
+        size_t first = blk * AOSOA_LANES;
+        int lanes = (int)std::min<size_t>(AOSOA_LANES, count - first);
+
+        for (int l = 0; l < lanes; ++l) {
+            float *matrix = dst + (first + l) * elems;
+            for (size_t e = 0; e < elems; ++e) {
+                matrix[e] = block[e * AOSOA_LANES + l];
+            }
+        }
+    }
+}
+
+void aosoa_matrix_multiply(const float *A, const float *B, float *C, int M,
+                           int N, int K, size_t count) {
+    if (M < 0 || N < 0 || K < 0) {
+        throw std::invalid_argument("Matrix dimensions must not be negative");
+    }
+    if (M == 0 || N == 0 || count == 0) {
+        return;
+    }
+
+    AosoaKernel kernel = select_aosoa_kernel(M, N, K);
+    size_t blocks = (count + AOSOA_LANES - 1) / AOSOA_LANES;
+    size_t tasks = (blocks + AOSOA_BLOCKS_PER_TASK - 1) / AOSOA_BLOCKS_PER_TASK;
+
+    if (tasks <= 1) {
+        kernel(A, B, C, M, N, K, 0, blocks);
+        return;
+    }
+
+    WorkStealingScheduler::instance().parallelFor(
+        (int)tasks, [&](int task, int) {
+            size_t begin = (size_t)task * AOSOA_BLOCKS_PER_TASK;
+            size_t end = std::min(blocks, begin + AOSOA_BLOCKS_PER_TASK);
+            kernel(A, B, C, M, N, K, begin, end);
+        });
+}
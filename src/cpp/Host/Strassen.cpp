@@ -0,0 +1,175 @@
+#include <Host/AlignedBuffer.hpp>
+#include <Host/HostGemm.hpp>
+#include <Host/Strassen.hpp>
+#include <Host/WorkStealingScheduler.hpp>
+#include <algorithm>
+#include <stdexcept>
+
+// Additions smaller than this many elements run on the calling thread
+constexpr size_t STRASSEN_PARALLEL_ADD = 1 << 16;
+
+// Rows per task of a parallel addition
+constexpr int STRASSEN_ADD_ROWS = 32;
+
+// Z = X + sign * Y for rows x cols matrices. Z may alias X or Y.
+static void matrix_add(int rows, int cols, const float *X, int ldx,
+                       const float *Y, int ldy, float sign, float *Z,
+                       int ldz) {
+    auto add_rows = [&](int r0, int r1) {
+        for (int i = r0; i < r1; ++i) {
+            const float *x = X + (size_t)i * ldx;
+            const float *y = Y + (size_t)i * ldy;
+            float *z = Z + (size_t)i * ldz;
+            for (int j = 0; j < cols; ++j) {
+                z[j] = x[j] + sign * y[j];
+            }
+        }
+    };
+
+    if ((size_t)rows * cols < STRASSEN_PARALLEL_ADD) {
+        add_rows(0, rows);
+        return;
+    }
+
+    int tasks = (rows + STRASSEN_ADD_ROWS - 1) / STRASSEN_ADD_ROWS;
+    WorkStealingScheduler::instance().parallelFor(tasks, [&](int task, int) {
+        int r0 = task * STRASSEN_ADD_ROWS;
+        add_rows(r0, std::min(rows, r0 + STRASSEN_ADD_ROWS));
+    });
+}
+
+static bool is_base_case(int M, int N, int K, int crossover) {
+    return std::min(M, std::min(N, K)) <= std::max(crossover, 1);
+}
+
+// Floats of workspace used by winograd() for this shape: three half-size
+// temporaries per level of recursion
+static size_t workspace_size(int M, int N, int K, int crossover) {
+    size_t total = 0;
+    while (!is_base_case(M, N, K, crossover)) {
+        M /= 2;
+        N /= 2;
+        K /= 2;
+        total += (size_t)M * K + (size_t)K * N + (size_t)M * N;
+    }
+    return total;
+}
+
+// C = A * B. The seven products are scheduled so that C's quadrants double
+// as accumulators and only X (m2 x k2), Y (k2 x n2) and Z (m2 x n2) are
+// needed per level, with the deeper levels using the workspace after them.
+static void winograd(int M, int N, int K, const float *A, int lda,
+                     const float *B, int ldb, float *C, int ldc, int crossover,
+                     float *work) {
+    if (is_base_case(M, N, K, crossover)) {
+        sgemm('N', 'N', M, N, K, 1.0f, A, lda, B, ldb, 0.0f, C, ldc);
+        return;
+    }
+
+    int m2 = M / 2;
+    int n2 = N / 2;
+    int k2 = K / 2;
+
+    float *X = work;
+    float *Y = X + (size_t)m2 * k2;
+    float *Z = Y + (size_t)k2 * n2;
+    float *next = Z + (size_t)m2 * n2;
+
+    const float *A11 = A;
+    const float *A12 = A + k2;
+    const float *A21 = A + (size_t)m2 * lda;
+    const float *A22 = A21 + k2;
+    const float *B11 = B;
+    const float *B12 = B + n2;
+    const float *B21 = B + (size_t)k2 * ldb;
+    const float *B22 = B21 + n2;
+    float *C11 = C;
+    float *C12 = C + n2;
+    float *C21 = C + (size_t)m2 * ldc;
+    float *C22 = C21 + n2;
+
+    auto multiply = [&](const float *P, int ldp, const float *Q, int ldq,
+                        float *R) {
+        winograd(m2, n2, k2, P, ldp, Q, ldq, R, ldc, crossover, next);
+    };
+
+    // P7 = (A11 - A21)(B22 - B12) -> C21
+    matrix_add(m2, k2, A11, lda, A21, lda, -1.0f, X, k2);
+    matrix_add(k2, n2, B22, ldb, B12, ldb, -1.0f, Y, n2);
+    multiply(X, k2, Y, n2, C21);
+
+    // P5 = (A21 + A22)(B12 - B11) -> C22
+    matrix_add(m2, k2, A21, lda, A22, lda, 1.0f, X, k2);
+    matrix_add(k2, n2, B12, ldb, B11, ldb, -1.0f, Y, n2);
+    multiply(X, k2, Y, n2, C22);
+
+    // P6 = (S1 - A11)(B22 - T1) -> C12
+    matrix_add(m2, k2, X, k2, A11, lda, -1.0f, X, k2);
+    matrix_add(k2, n2, B22, ldb, Y, n2, -1.0f, Y, n2);
+    multiply(X, k2, Y, n2, C12);
+
+    // P3 = (A12 - S2) B22 -> C11
+    matrix_add(m2, k2, A12, lda, X, k2, -1.0f, X, k2);
+    multiply(X, k2, B22, ldb, C11);
+
+    // P1 = A11 B11 -> Z
+    winograd(m2, n2, k2, A11, lda, B11, ldb, Z, n2, crossover, next);
+
+    matrix_add(m2, n2, C12, ldc, Z, n2, 1.0f, C12, ldc);   // U2 = P1 + P6
+    matrix_add(m2, n2, C21, ldc, C12, ldc, 1.0f, C21, ldc); // U3 = U2 + P7
+    matrix_add(m2, n2, C12, ldc, C22, ldc, 1.0f, C12, ldc); // U4 = U2 + P5
+    matrix_add(m2, n2, C22, ldc, C21, ldc, 1.0f, C22, ldc); // U7 = U3 + P5
+    matrix_add(m2, n2, C12, ldc, C11, ldc, 1.0f, C12, ldc); // U5 = U4 + P3
+
+    // P4 = A22 (T2 - B21) -> C11, U6 = U3 - P4
+    matrix_add(k2, n2, Y, n2, B21, ldb, -1.0f, Y, n2);
+    multiply(A22, lda, Y, n2, C11);
+    matrix_add(m2, n2, C21, ldc, C11, ldc, -1.0f, C21, ldc);
+
+    // U1 = P1 + P2
+    multiply(A12, lda, B21, ldb, C11);
+    matrix_add(m2, n2, C11, ldc, Z, n2, 1.0f, C11, ldc);
+
+    // Dynamic peeling of odd dimensions
+    if (K > 2 * k2) {
+        sgemm('N', 'N', 2 * m2, 2 * n2, 1, 1.0f, A + 2 * k2, lda,
+              B + (size_t)2 * k2 * ldb, ldb, 1.0f, C, ldc);
+    }
+    if (N > 2 * n2) {
+        sgemm('N', 'N', 2 * m2, 1, K, 1.0f, A, lda, B + 2 * n2, ldb, 0.0f,
+              C + 2 * n2, ldc);
+    }
+    if (M > 2 * m2) {
+        sgemm('N', 'N', 1, N, K, 1.0f, A + (size_t)2 * m2 * lda, lda, B, ldb,
+              0.0f, C + (size_t)2 * m2 * ldc, ldc);
+    }
+}
+
+void strassen_matrix_multiply(const float *matA, const float *matB,
+                              float *matC, int M, int N, int K, int lda,
+                              int ldb, int ldc, int crossover) {
+    if (crossover < 1) {
+        throw std::invalid_argument("Strassen crossover must be at least 1");
+    }
+    if (is_base_case(M, N, K, crossover)) {
+        // Also validates the arguments
+        host_matrix_multiply(matA, matB, matC, M, N, K, lda, ldb, ldc);
+        return;
+    }
+    if (lda < K || ldb < N || ldc < N) {
+        throw std::invalid_argument(
+            "Leading dimension is smaller than the matrix row");
+    }
+
+    thread_local AlignedBuffer workspace;
+    float *work = workspace.reserve(workspace_size(M, N, K, crossover));
+
+    winograd(M, N, K, matA, lda, matB, ldb, matC, ldc, crossover, work);
+}
+
+void strassen_matrix_multiply(const float *matA, const float *matB,
+                              float *matC, int M, int N, int K, int lda,
+                              int ldb, int ldc) {
+    strassen_matrix_multiply(matA, matB, matC, M, N, K, lda, ldb, ldc,
+                             STRASSEN_DEFAULT_CROSSOVER);
+}
@@ -0,0 +1,145 @@
+#include <Host/ThreadPool.hpp>
+#include <algorithm>
+#include <cstdlib>
+
+// Set on pool threads and while the calling thread runs a job, so that nested
+// submissions can be detected
+static thread_local bool t_inside_pool = false;
+
+ThreadPool::ThreadPool(int nthreads) {
+    for (int worker = 1; worker < nthreads; ++worker) {
+        m_threads.emplace_back(&ThreadPool::workerLoop, this, worker);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_start.notify_all();
+    for (std::thread &thread : m_threads) {
+        thread.join();
+    }
+}
+
+void ThreadPool::workerLoop(int worker) {
+    t_inside_pool = true;
+    uint64_t seen = 0;
+
+    for (;;) {
+        const std::function<void(int)> *job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_start.wait(lock,
+                         [&] { return m_stop || m_generation != seen; });
+            if (m_stop) {
+                return;
+            }
+            seen = m_generation;
+            job = m_job;
+        }
+
+        std::exception_ptr error;
+        try {
+            (*job)(worker);
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (error && !m_error) {
+            m_error = error;
+        }
+        if (--m_pending == 0) {
+            m_done.notify_one();
+        }
+    }
+}
+
+void ThreadPool::runSerial(const std::function<void(int)> &job) {
+    for (int worker = 0; worker < size(); ++worker) {
+        job(worker);
+    }
+}
+
+void ThreadPool::run(const std::function<void(int)> &job) {
+    if (m_threads.empty() || t_inside_pool) {
+        runSerial(job);
+        return;
+    }
+
+    std::unique_lock<std::mutex> run_lock(m_run_mutex, std::try_to_lock);
+    if (!run_lock) {
+        runSerial(job);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_job = &job;
+        m_pending = (int)m_threads.size();
+        m_error = nullptr;
+        ++m_generation;
+    }
+    m_start.notify_all();
+
+    std::exception_ptr error;
+    t_inside_pool = true;
+    try {
+        job(0);
+    } catch (...) {
+        error = std::current_exception();
+    }
+    t_inside_pool = false;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [&] { return m_pending == 0; });
+    m_job = nullptr;
+    if (!error) {
+        error = m_error;
+    }
+    lock.unlock();
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void ThreadPool::parallelFor(int ntasks,
+                             const std::function<void(int, int)> &fn) {
+    if (ntasks <= 0) {
+        return;
+    }
+
+    int nworkers = std::min(size(), ntasks);
+    if (nworkers == 1) {
+        for (int task = 0; task < ntasks; ++task) {
+            fn(task, 0);
+        }
+        return;
+    }
+
+    run([&](int worker) {
+        if (worker >= nworkers) {
+            return;
+        }
+        int begin = (int)((long long)ntasks * worker / nworkers);
+        int end = (int)((long long)ntasks * (worker + 1) / nworkers);
+        for (int task = begin; task < end; ++task) {
+            fn(task, worker);
+        }
+    });
+}
+
+ThreadPool &ThreadPool::instance() {
+    static ThreadPool pool([] {
+        const char *env = std::getenv("HOST_GEMM_THREADS");
+        int nthreads = env ? std::atoi(env) : 0;
+        if (nthreads <= 0) {
+            nthreads = (int)std::thread::hardware_concurrency();
+        }
+        return std::max(1, nthreads);
+    }());
+    return pool;
+}
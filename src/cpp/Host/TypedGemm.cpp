@@ -0,0 +1,406 @@
+#include <Host/AlignedBuffer.hpp>
+#include <Host/GemmEngine.hpp>
+#include <Host/GemmKernels.hpp>
+#include <Host/HostGemm.hpp>
+#include <Host/TypedGemm.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+// Complex products run on the blocked engine of HostGemm.cpp, which owns
+// blocking, scheduling and tiling. What lives here is the complex layer
+// underneath it: every block is split into real planes and multiplied with
+// the micro-kernels of the component type.
+
+namespace {
+
+constexpr size_t PACK_ALIGNMENT = AlignedBuffer::ALIGNMENT;
+
+template <class R> const GemmKernelOf<R> &real_kernel();
+
+template <> const GemmKernelOf<float> &real_kernel<float>() {
+    return gemm_kernel();
+}
+
+template <> const GemmKernelOf<double> &real_kernel<double>() {
+    return dgemm_kernel();
+}
+
+// View of op starting at its element (i, j)
+template <class T>
+GemmStrided<T> strided_at(const GemmStrided<T> &op, int i, int j) {
+    return {op.data + (ptrdiff_t)i * op.rs + (ptrdiff_t)j * op.cs, op.rs,
+            op.cs, op.conj};
+}
+
+// Real planes of a complex block
+int plane_count(ComplexGemmMethod method) {
+    return method == ComplexGemmMethod::ThreeM ? 3 : 2;
+}
+
+// Splits a rows x cols complex block, element (i, j) at src[i * rs + j * cs],
+// into planes of its real parts, its imaginary parts (negated for a
+// conjugated operand) and, for 3M, their sums, each rows * cols values long
+// at dst. Like widen_block in GemmKernels.cpp the planes keep the block's
+// orientation so that the reads stay contiguous; returns their strides.
+template <class R>
+std::pair<ptrdiff_t, ptrdiff_t>
+split_block(int rows, int cols, const GemmStrided<std::complex<R>> &op,
+            int planes, R *dst) {
+    bool by_column = op.rs == 1 && op.cs != 1;
+    int outer = by_column ? cols : rows;
+    int inner = by_column ? rows : cols;
+    ptrdiff_t outer_stride = by_column ? op.cs : op.rs;
+    ptrdiff_t inner_stride = by_column ? op.rs : op.cs;
+    size_t plane = (size_t)rows * cols;
+    R sign = op.conj ? R(-1) : R(1);
+
+    for (int o = 0; o < outer; ++o) {
+        // std::complex is laid out as {real, imag}
+        const R *src = reinterpret_cast<const R *>(op.data + o * outer_stride);
+        R *re = dst + (size_t)o * inner;
+        R *im = re + plane;
+        for (int t = 0; t < inner; ++t) {
+            re[t] = src[2 * t * inner_stride];
+            im[t] = sign * src[2 * t * inner_stride + 1];
+        }
+        if (planes == 3) {
+            R *sum = im + plane;
+            for (int t = 0; t < inner; ++t) {
+                sum[t] = re[t] + im[t];
+            }
+        }
+    }
+    if (by_column) {
+        return {1, rows};
+    }
+    return {cols, 1};
+}
+
+// Multiplies the planes of a packed mc x kc block of A with those of a packed
+// kc x nc panel of B into the matching block of C. Each register tile is
+// assembled in real scratch tiles that stay in L1, and merged into C with
+// the complex alpha and beta.
+template <class R>
+void complex_macro_kernel(const GemmKernelOf<R> &kernel,
+                          ComplexGemmMethod method, int mc, int nc, int kc,
+                          const R *packed_a, size_t a_plane,
+                          const R *packed_b, size_t b_plane,
+                          std::complex<R> *c, int ldc, std::complex<R> alpha,
+                          std::complex<R> beta) {
+    const int MR = kernel.blocking.mr;
+    const int NR = kernel.blocking.nr;
+    alignas(PACK_ALIGNMENT) R t0[GEMM_MAX_TILE];
+    alignas(PACK_ALIGNMENT) R t1[GEMM_MAX_TILE];
+    alignas(PACK_ALIGNMENT) R t2[GEMM_MAX_TILE];
+    const R ar = alpha.real(), ai = alpha.imag();
+    const R br = beta.real(), bi = beta.imag();
+    const bool beta_zero = beta == std::complex<R>(0);
+    const bool beta_one = beta == std::complex<R>(1);
+
+    for (int jr = 0; jr < nc; jr += NR) {
+        int nr = std::min(NR, nc - jr);
+        const R *b_re = packed_b + (size_t)jr * kc;
+        const R *b_im = b_re + b_plane;
+
+        for (int ir = 0; ir < mc; ir += MR) {
+            int mr = std::min(MR, mc - ir);
+            const R *a_re = packed_a + (size_t)ir * kc;
+            const R *a_im = a_re + a_plane;
+
+            // Real parts end up in t0 and imaginary parts in t1
+            if (method == ComplexGemmMethod::ThreeM) {
+                kernel.fn(kc, a_re, b_re, t0, NR, R(1), R(0));
+                kernel.fn(kc, a_im, b_im, t1, NR, R(1), R(0));
+                kernel.fn(kc, a_im + a_plane, b_im + b_plane, t2, NR, R(1),
+                          R(0));
+                for (int t = 0; t < MR * NR; ++t) {
+                    R rr = t0[t], ii = t1[t];
+                    t0[t] = rr - ii;
+                    t1[t] = t2[t] - rr - ii;
+                }
+            } else {
+                kernel.fn(kc, a_re, b_re, t0, NR, R(1), R(0));
+                kernel.fn(kc, a_im, b_im, t0, NR, R(-1), R(1));
+                kernel.fn(kc, a_re, b_im, t1, NR, R(1), R(0));
+                kernel.fn(kc, a_im, b_re, t1, NR, R(1), R(1));
+            }
+
+            for (int i = 0; i < mr; ++i) {
+                R *row = reinterpret_cast<R *>(c + (size_t)(ir + i) * ldc +
+                                               jr);
+                const R *re = t0 + i * NR;
+                const R *im = t1 + i * NR;
+                for (int j = 0; j < nr; ++j) {
+                    R vr = ar * re[j] - ai * im[j];
+                    R vi = ar * im[j] + ai * re[j];
+                    if (beta_one) {
+                        vr += row[2 * j];
+                        vi += row[2 * j + 1];
+                    } else if (!beta_zero) {
+                        R cr = row[2 * j], ci = row[2 * j + 1];
+                        vr += br * cr - bi * ci;
+                        vi += br * ci + bi * cr;
+                    }
+                    row[2 * j] = vr;
+                    row[2 * j + 1] = vi;
+                }
+            }
+        }
+    }
+}
+
+} // namespace
+
+template <class R>
+ComplexGemmKernel<R> complex_gemm_kernel(ComplexGemmMethod method) {
+    const GemmKernelOf<R> &real = real_kernel<R>();
+    GemmBlocking blocking = real.blocking;
+    // Two or three planes per block; halving kc keeps the packed blocks
+    // within the cache budget the real blocking was sized for
+    blocking.kc = std::max(blocking.kc / 2, 1);
+    return {&real, method, blocking};
+}
+
+template <class R>
+void complex_gemm_block(const ComplexGemmKernel<R> &kernel, int M, int N,
+                        int K, std::complex<R> alpha,
+                        const GemmStrided<std::complex<R>> &a,
+                        const GemmStrided<std::complex<R>> &b,
+                        std::complex<R> beta, std::complex<R> *C, int ldc) {
+    const GemmBlocking &blk = kernel.blocking;
+    int planes = plane_count(kernel.method);
+
+    thread_local AlignedBuffer buffer_a;
+    thread_local AlignedBuffer buffer_b;
+    thread_local AlignedBuffer buffer_split;
+
+    int mc_max = std::min(blk.mc, (M + blk.mr - 1) / blk.mr * blk.mr);
+    int nc_max = std::min(blk.nc, (N + blk.nr - 1) / blk.nr * blk.nr);
+    int kc_max = std::min(blk.kc, K);
+    size_t a_plane = (size_t)mc_max * kc_max;
+    size_t b_plane = (size_t)kc_max * nc_max;
+
+    R *packed_a = buffer_a.reserve_as<R>(planes * a_plane);
+    R *packed_b = buffer_b.reserve_as<R>(planes * b_plane);
+    R *split = buffer_split.reserve_as<R>(planes * std::max(a_plane, b_plane));
+
+    for (int jc = 0; jc < N; jc += blk.nc) {
+        int nc = std::min(blk.nc, N - jc);
+
+        for (int pc = 0; pc < K; pc += blk.kc) {
+            int kc = std::min(blk.kc, K - pc);
+            std::complex<R> beta_block = pc == 0 ? beta : std::complex<R>(1);
+
+            auto strides =
+                split_block(kc, nc, strided_at(b, pc, jc), planes, split);
+            for (int q = 0; q < planes; ++q) {
+                gemm_pack_b(blk.nr, kc, nc, split + (size_t)q * kc * nc,
+                            strides.first, strides.second,
+                            packed_b + q * b_plane);
+            }
+
+            for (int ic = 0; ic < M; ic += blk.mc) {
+                int mc = std::min(blk.mc, M - ic);
+
+                strides =
+                    split_block(mc, kc, strided_at(a, ic, pc), planes, split);
+                for (int q = 0; q < planes; ++q) {
+                    gemm_pack_a(blk.mr, mc, kc, split + (size_t)q * mc * kc,
+                                strides.first, strides.second,
+                                packed_a + q * a_plane);
+                }
+                complex_macro_kernel(*kernel.real, kernel.method, mc, nc, kc,
+                                     packed_a, a_plane, packed_b, b_plane,
+                                     C + (size_t)ic * ldc + jc, ldc, alpha,
+                                     beta_block);
+            }
+        }
+    }
+}
+
+#define COMPLEX_GEMM(R)                                                        \
+    template ComplexGemmKernel<R> complex_gemm_kernel(ComplexGemmMethod);      \
+    template void complex_gemm_block(                                          \
+        const ComplexGemmKernel<R> &, int, int, int, std::complex<R>,          \
+        const GemmStrided<std::complex<R>> &,                                  \
+        const GemmStrided<std::complex<R>> &, std::complex<R>,                 \
+        std::complex<R> *, int);
+
+COMPLEX_GEMM(float)
+COMPLEX_GEMM(double)
+
+namespace {
+
+// Parses a transpose flag. 'C' conjugates complex operands and is the same
+// as 'T' for real ones.
+void parse_trans(char trans, bool &transposed, bool &conj) {
+    switch (trans) {
+    case 'N':
+    case 'n':
+        transposed = false;
+        conj = false;
+        return;
+    case 'T':
+    case 't':
+        transposed = true;
+        conj = false;
+        return;
+    case 'C':
+    case 'c':
+        transposed = true;
+        conj = true;
+        return;
+    default:
+        throw std::invalid_argument("Transpose flag must be 'N', 'T' or 'C'");
+    }
+}
+
+ComplexGemmMethod complex_method_from_env() {
+    const char *env = std::getenv("HOST_GEMM_COMPLEX");
+
+    if (env && !std::strcmp(env, "3m")) {
+        return ComplexGemmMethod::ThreeM;
+    }
+    return ComplexGemmMethod::Standard;
+}
+
+std::atomic<ComplexGemmMethod> &complex_method_setting() {
+    static std::atomic<ComplexGemmMethod> method(complex_method_from_env());
+    return method;
+}
+
+// Kernel a product of element type T runs on
+const GemmKernelOf<double> &engine_kernel(const double *) {
+    return real_kernel<double>();
+}
+
+template <class R>
+ComplexGemmKernel<R> engine_kernel(const std::complex<R> *) {
+    return complex_gemm_kernel<R>(host_gemm_complex_method());
+}
+
+// Validates BLAS-style arguments and runs the product on the engine
+template <class T>
+void typed_gemm(char transA, char transB, int M, int N, int K, T alpha,
+                const T *A, int lda, const T *B, int ldb, T beta, T *C,
+                int ldc,
+                const GemmEpilogueOf<T> &epilogue = GemmEpilogueOf<T>()) {
+    bool ta, ca, tb, cb;
+    parse_trans(transA, ta, ca);
+    parse_trans(transB, tb, cb);
+
+    if (M < 0 || N < 0 || K < 0) {
+        throw std::invalid_argument("Matrix dimensions must not be negative");
+    }
+    if (lda < std::max(1, ta ? M : K) || ldb < std::max(1, tb ? K : N) ||
+        ldc < std::max(1, N)) {
+        throw std::invalid_argument(
+            "Leading dimension is smaller than the matrix row");
+    }
+    check_epilogue(epilogue, N);
+
+    // conj only matters to the complex layer, real types ignore it
+    GemmStrided<T> a = ta ? GemmStrided<T>{A, 1, lda, ca}
+                          : GemmStrided<T>{A, lda, 1, false};
+    GemmStrided<T> b = tb ? GemmStrided<T>{B, 1, ldb, cb}
+                          : GemmStrided<T>{B, ldb, 1, false};
+    gemm_engine(engine_kernel(C), M, N, K, alpha, a, b, beta, C, ldc,
+                epilogue);
+}
+
+// C = A * B in every supported precision
+void typed_multiply(const float *A, const float *B, float *C, int M, int N,
+                    int K, int lda, int ldb, int ldc) {
+    sgemm('N', 'N', M, N, K, 1.0f, A, lda, B, ldb, 0.0f, C, ldc);
+}
+
+template <class T>
+void typed_multiply(const T *A, const T *B, T *C, int M, int N, int K,
+                    int lda, int ldb, int ldc) {
+    typed_gemm('N', 'N', M, N, K, T(1), A, lda, B, ldb, T(0), C, ldc);
+}
+
+} // namespace
+
+void host_gemm_set_complex_method(ComplexGemmMethod method) {
+    complex_method_setting().store(method);
+}
+
+ComplexGemmMethod host_gemm_complex_method() {
+    return complex_method_setting().load();
+}
+
+void dgemm(char transA, char transB, int M, int N, int K, double alpha,
+           const double *A, int lda, const double *B, int ldb, double beta,
+           double *C, int ldc) {
+    typed_gemm(transA, transB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc);
+}
+
+void cgemm(char transA, char transB, int M, int N, int K,
+           std::complex<float> alpha, const std::complex<float> *A, int lda,
+           const std::complex<float> *B, int ldb, std::complex<float> beta,
+           std::complex<float> *C, int ldc) {
+    typed_gemm(transA, transB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc);
+}
+
+void zgemm(char transA, char transB, int M, int N, int K,
+           std::complex<double> alpha, const std::complex<double> *A, int lda,
+           const std::complex<double> *B, int ldb, std::complex<double> beta,
+           std::complex<double> *C, int ldc) {
+    typed_gemm(transA, transB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc);
+}
+
+void dgemm_epilogue(char transA, char transB, int M, int N, int K,
+                    double alpha, const double *A, int lda, const double *B,
+                    int ldb, double beta, double *C, int ldc,
+                    const GemmEpilogueOf<double> &epilogue) {
+    typed_gemm(transA, transB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc,
+               epilogue);
+}
+
+void cgemm_epilogue(char transA, char transB, int M, int N, int K,
+                    std::complex<float> alpha, const std::complex<float> *A,
+                    int lda, const std::complex<float> *B, int ldb,
+                    std::complex<float> beta, std::complex<float> *C, int ldc,
+                    const GemmEpilogueOf<std::complex<float>> &epilogue) {
+    typed_gemm(transA, transB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc,
+               epilogue);
+}
+
+void zgemm_epilogue(char transA, char transB, int M, int N, int K,
+                    std::complex<double> alpha, const std::complex<double> *A,
+                    int lda, const std::complex<double> *B, int ldb,
+                    std::complex<double> beta, std::complex<double> *C,
+                    int ldc,
+                    const GemmEpilogueOf<std::complex<double>> &epilogue) {
+    typed_gemm(transA, transB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc,
+               epilogue);
+}
+
+template <class T>
+void host_matrix_multiply(const T *matA, const T *matB, T *matC, int M, int N,
+                          int K, int lda, int ldb, int ldc) {
+    typed_multiply(matA, matB, matC, M, N, K, lda, ldb, ldc);
+}
+
+template <class T>
+void host_matrix_multiply(const T *matA, const T *matB, T *matC, int M, int N,
+                          int K) {
+    host_matrix_multiply(matA, matB, matC, M, N, K, std::max(1, K),
+                         std::max(1, N), std::max(1, N));
+}
+
+#define HOST_MATRIX_MULTIPLY(T)                                                \
+    template void host_matrix_multiply(const T *, const T *, T *, int, int,   \
+                                       int, int, int, int);                    \
+    template void host_matrix_multiply(const T *, const T *, T *, int, int,   \
+                                       int);
+
+HOST_MATRIX_MULTIPLY(float)
+HOST_MATRIX_MULTIPLY(double)
+HOST_MATRIX_MULTIPLY(std::complex<float>)
+HOST_MATRIX_MULTIPLY(std::complex<double>)
@@ -0,0 +1,103 @@
+#include <Host/WorkStealingScheduler.hpp>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+
+namespace {
+
+// Deque of a worker. Tasks are seeded and stolen in contiguous runs, so the
+// deque is always a single index range [begin, end): the owner pops at
+// begin and thieves split off the upper half.
+struct alignas(64) TaskDeque {
+    std::mutex mutex;
+    int begin = 0;
+    int end = 0;
+
+    bool pop(int &task) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (begin >= end) {
+            return false;
+        }
+        task = begin++;
+        return true;
+    }
+
+    bool stealHalf(int &steal_begin, int &steal_end) {
+        std::lock_guard<std::mutex> lock(mutex);
+        int remaining = end - begin;
+        if (remaining <= 0) {
+            return false;
+        }
+        steal_end = end;
+        steal_begin = end - (remaining + 1) / 2;
+        end = steal_begin;
+        return true;
+    }
+
+    void assign(int new_begin, int new_end) {
+        std::lock_guard<std::mutex> lock(mutex);
+        begin = new_begin;
+        end = new_end;
+    }
+};
+
+} // namespace
+
+void WorkStealingScheduler::parallelFor(
+    int ntasks, const std::function<void(int, int)> &fn) {
+    if (ntasks <= 0) {
+        return;
+    }
+
+    int nworkers = std::min(m_pool.size(), ntasks);
+    if (nworkers == 1) {
+        for (int task = 0; task < ntasks; ++task) {
+            fn(task, 0);
+        }
+        return;
+    }
+
+    // Per call rather than per scheduler, so that a nested or concurrent
+    // call that falls back to serial execution cannot see another call's
+    // deques
+    std::unique_ptr<TaskDeque[]> deques(new TaskDeque[nworkers]);
+    for (int worker = 0; worker < nworkers; ++worker) {
+        deques[worker].begin = (int)((long long)ntasks * worker / nworkers);
+        deques[worker].end =
+            (int)((long long)ntasks * (worker + 1) / nworkers);
+    }
+
+    m_pool.run([&](int worker) {
+        if (worker >= nworkers) {
+            return;
+        }
+        TaskDeque &own = deques[worker];
+
+        for (;;) {
+            int task;
+            while (own.pop(task)) {
+                fn(task, worker);
+            }
+
+            // Tasks are never created while the loop runs, so one full pass
+            // over the other workers without finding work means we are done
+            bool stole = false;
+            for (int i = 1; i < nworkers && !stole; ++i) {
+                int victim = (worker + i) % nworkers;
+                int steal_begin, steal_end;
+                if (deques[victim].stealHalf(steal_begin, steal_end)) {
+                    own.assign(steal_begin, steal_end);
+                    stole = true;
+                }
+            }
+            if (!stole) {
+                return;
+            }
+        }
+    });
+}
+
+WorkStealingScheduler &WorkStealingScheduler::instance() {
+    static WorkStealingScheduler scheduler(ThreadPool::instance());
+    return scheduler;
+}
@@ -0,0 +1,178 @@
+#include <Metal/AutoreleasePoolGuard.hpp>
+#include <Metal/MetalBuffer.hpp>
+#include <Metal/MetalContext.hpp>
+#include <Metal/MetalGemm.hpp>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+
+// Threads per threadgroup along the N and M axes of the grid
+#define BLOCK_SIZE 16
+
+static_assert((uint32_t)GemmActivation::None == GEMM_ACTIVATION_NONE &&
+                  (uint32_t)GemmActivation::ReLU == GEMM_ACTIVATION_RELU &&
+                  (uint32_t)GemmActivation::GELU == GEMM_ACTIVATION_GELU,
+              "GemmActivation must match the Metal activation constants");
+
+// Number of elements spanned by a rows x cols matrix with row stride ld; the
+// last row only needs its first cols values
+static size_t matrix_extent(uint32_t rows, uint32_t cols, uint32_t ld) {
+    return rows ? (size_t)(rows - 1) * ld + cols : 0;
+}
+
+// The leading dimension checks of sgemm, so that the host and device paths
+// accept the same arguments
+static void check_leading_dimensions(const GemmParams &params) {
+    if (params.lda < std::max(1u, params.K) ||
+        params.ldb < std::max(1u, params.N) ||
+        params.ldc < std::max(1u, params.N)) {
+        throw std::invalid_argument(
+            "Leading dimension is smaller than the matrix row");
+    }
+}
+
+// Number of elements spanned by a strided batch of rows x cols matrices
+static size_t batch_extent(uint32_t rows, uint32_t cols, uint32_t ld,
+                           uint32_t stride, uint32_t batch) {
+    return (size_t)(batch - 1) * stride + matrix_extent(rows, cols, ld);
+}
+
+void device_matrix_multiply(const char *lib, const float *matA,
+                            const float *matB, float *matC,
+                            const GemmParams &params,
+                            const GemmEpilogue &epilogue) {
+    check_leading_dimensions(params);
+    check_epilogue(epilogue, params.N);
+    if (params.M == 0 || params.N == 0) {
+        return;
+    }
+
+    AutoreleasePoolGuard guard;
+
+    MetalContext multiplier(lib, "device_matrix_multiply");
+
+    // C may be a view that ends at its last element, so no buffer reaches
+    // past the last row's own values
+    size_t sizeA = sizeof(float) * std::max<size_t>(
+                                       1, matrix_extent(params.M, params.K,
+                                                        params.lda));
+    size_t sizeB = sizeof(float) * std::max<size_t>(
+                                       1, matrix_extent(params.K, params.N,
+                                                        params.ldb));
+    size_t sizeC =
+        sizeof(float) * matrix_extent(params.M, params.N, params.ldc);
+    size_t sizeRow = sizeof(float) * params.N;
+    size_t sizeResidual =
+        sizeof(float) * matrix_extent(params.M, params.N, epilogue.ldr);
+
+    GemmParams device_params = params;
+    device_params.epilogue = 0;
+    device_params.activation = (uint32_t)epilogue.activation;
+    device_params.ldr = epilogue.residual ? epilogue.ldr : 0;
+
+    MetalBuffer bufA(multiplier, sizeA);
+    MetalBuffer bufB(multiplier, sizeB);
+    MetalBuffer bufC(multiplier, sizeC);
+    MetalBuffer bufParams(multiplier, sizeof(GemmParams));
+    // Stands in for the epilogue inputs that are not used
+    MetalBuffer bufUnused(multiplier, sizeof(float));
+
+    std::unique_ptr<MetalBuffer> bufScale, bufBias, bufResidual;
+    if (epilogue.scale) {
+        device_params.epilogue |= GEMM_EPILOGUE_SCALE;
+        bufScale = std::make_unique<MetalBuffer>(multiplier, sizeRow);
+        bufScale->fillBuffer(const_cast<float *>(epilogue.scale), sizeRow);
+    }
+    if (epilogue.bias) {
+        device_params.epilogue |= GEMM_EPILOGUE_BIAS;
+        bufBias = std::make_unique<MetalBuffer>(multiplier, sizeRow);
+        bufBias->fillBuffer(const_cast<float *>(epilogue.bias), sizeRow);
+    }
+    if (epilogue.residual) {
+        device_params.epilogue |= GEMM_EPILOGUE_RESIDUAL;
+        bufResidual = std::make_unique<MetalBuffer>(multiplier, sizeResidual);
+        bufResidual->fillBuffer(const_cast<float *>(epilogue.residual),
+                                sizeResidual);
+    }
+
+    bufA.fillBuffer(const_cast<float *>(matA), params.K ? sizeA : 0);
+    bufB.fillBuffer(const_cast<float *>(matB), params.K ? sizeB : 0);
+    bufC.fillBuffer(matC, sizeC);
+    bufParams.fillBuffer(&device_params, sizeof(GemmParams));
+
+    multiplier.setBuffer(bufA, 0, 0);
+    multiplier.setBuffer(bufB, 0, 1);
+    multiplier.setBuffer(bufC, 0, 2);
+    multiplier.setBuffer(bufParams, 0, 3);
+    multiplier.setBuffer(bufScale ? *bufScale : bufUnused, 0, 4);
+    multiplier.setBuffer(bufBias ? *bufBias : bufUnused, 0, 5);
+    multiplier.setBuffer(bufResidual ? *bufResidual : bufUnused, 0, 6);
+
+    MetalDim gridDim(params.N, params.M, 1);
+    MetalDim blockDim(std::min<NS::UInteger>(params.N, BLOCK_SIZE),
+                      std::min<NS::UInteger>(params.M, BLOCK_SIZE), 1);
+
+    multiplier.runKernel(gridDim, blockDim);
+
+    std::memcpy(matC, bufC.contents(), sizeC);
+}
+
+void device_matrix_multiply_batched(const char *lib, const float *matA,
+                                    const float *matB, float *matC,
+                                    const GemmParams &params) {
+    check_leading_dimensions(params);
+    // Members run concurrently, so they must not share elements of C
+    if (params.batch > 1 && params.M > 0 && params.N > 0 &&
+        params.strideC < matrix_extent(params.M, params.N, params.ldc)) {
+        throw std::invalid_argument(
+            "Batch stride of C makes the outputs overlap");
+    }
+    if (params.batch == 0 || params.M == 0 || params.N == 0) {
+        return;
+    }
+
+    AutoreleasePoolGuard guard;
+
+    MetalContext multiplier(lib, "device_matrix_multiply_batched");
+
+    size_t sizeA = sizeof(float) * std::max<size_t>(
+                                       1, batch_extent(params.M, params.K,
+                                                       params.lda,
+                                                       params.strideA,
+                                                       params.batch));
+    size_t sizeB = sizeof(float) * std::max<size_t>(
+                                       1, batch_extent(params.K, params.N,
+                                                       params.ldb,
+                                                       params.strideB,
+                                                       params.batch));
+    size_t sizeC = sizeof(float) * batch_extent(params.M, params.N, params.ldc,
+                                                params.strideC, params.batch);
+
+    MetalBuffer bufA(multiplier, sizeA);
+    MetalBuffer bufB(multiplier, sizeB);
+    MetalBuffer bufC(multiplier, sizeC);
+    MetalBuffer bufParams(multiplier, sizeof(GemmParams));
+
+    GemmParams device_params = params;
+
+    bufA.fillBuffer(const_cast<float *>(matA), params.K ? sizeA : 0);
+    bufB.fillBuffer(const_cast<float *>(matB), params.K ? sizeB : 0);
+    // C is copied in as well so that padding between rows and members
+    // survives the copy back
+    bufC.fillBuffer(matC, sizeC);
+    bufParams.fillBuffer(&device_params, sizeof(GemmParams));
+
+    multiplier.setBuffer(bufA, 0, 0);
+    multiplier.setBuffer(bufB, 0, 1);
+    multiplier.setBuffer(bufC, 0, 2);
+    multiplier.setBuffer(bufParams, 0, 3);
+
+    MetalDim gridDim(params.N, params.M, params.batch);
+    MetalDim blockDim(std::min<NS::UInteger>(params.N, BLOCK_SIZE),
+                      std::min<NS::UInteger>(params.M, BLOCK_SIZE), 1);
+
+    multiplier.runKernel(gridDim, blockDim);
+
+    std::memcpy(matC, bufC.contents(), sizeC);
+}
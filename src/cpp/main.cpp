@@ -1,70 +1,48 @@
 #define NS_PRIVATE_IMPLEMENTATION
 #define MTL_PRIVATE_IMPLEMENTATION
+#include <Host/HostGemm.hpp>
 #include <Metal/AutoreleasePoolGuard.hpp>
-#include <Metal/MetalBuffer.hpp>
-#include <Metal/MetalContext.hpp>
+#include <Metal/MetalGemm.hpp>
 #include <iostream>
+#include <memory>
 #include <utils/util.hpp>
 
-#define NROWS 3
-#define NCOLS 3
-
-void host_matrix_multiply(float *matA, float *matB, float *matC, int nrows,
-                          int ncols) {
-    for (int i = 0; i < nrows; ++i) {
-        for (int j = 0; j < ncols; ++j) {
-            float sum = 0;
-            for (int k = 0; k < nrows; ++k) {
-                sum += matA[i * nrows + k] * matB[k * ncols + j];
-            }
-            matC[i * nrows + j] = sum;
-        }
-    }
-}
+#define NROWS 3  // M: rows of A and C
+#define NCOLS 3  // N: columns of B and C
+#define NDEPTH 3 // K: columns of A and rows of B
 
 int main() {
 
     AutoreleasePoolGuard guard;
 
-    uint nrows = NROWS;
-
-    std::unique_ptr<float[]> matA = std::make_unique<float[]>(NROWS * NCOLS);
-    auto matB = std::make_unique<float[]>(NROWS * NCOLS);
-    auto matC = std::make_unique<float[]>(NROWS * NCOLS);
-    auto matH = std::make_unique<float[]>(NROWS * NCOLS);
-
-    populate_matrix(matA.get(), NROWS, NCOLS);
-    populate_matrix(matB.get(), NROWS, NCOLS);
-
-    MetalContext multiplier("build/matmul_kernel.metallib",
-                            "device_matrix_multiply");
-
-    MetalBuffer bufA(multiplier, sizeof(float) * NROWS * NCOLS);
-    MetalBuffer bufB(multiplier, sizeof(float) * NROWS * NCOLS);
-    MetalBuffer bufC(multiplier, sizeof(float) * NROWS * NCOLS);
-    MetalBuffer bufWidth(multiplier, sizeof(uint));
-
-    bufA.fillBuffer(matA.get(), sizeof(float) * NROWS * NCOLS);
-    bufB.fillBuffer(matB.get(), sizeof(float) * NROWS * NCOLS);
-    bufWidth.fillBuffer(&nrows, sizeof(uint));
-
-    multiplier.setBuffer(bufA, 0, 0);
-    multiplier.setBuffer(bufB, 0, 1);
-    multiplier.setBuffer(bufC, 0, 2);
-    multiplier.setBuffer(bufWidth, 0, 3);
+    GemmParams params = {};
+    params.M = NROWS;
+    params.N = NCOLS;
+    params.K = NDEPTH;
+    params.lda = NDEPTH;
+    params.ldb = NCOLS;
+    params.ldc = NCOLS;
 
-    MetalDim gridDim(NROWS, NCOLS, 1);
-    MetalDim blockDim(NROWS, NCOLS, 1);
+    std::unique_ptr<float[]> matA =
+        std::make_unique<float[]>(params.M * params.lda);
+    auto matB = std::make_unique<float[]>(params.K * params.ldb);
+    auto matC = std::make_unique<float[]>(params.M * params.ldc);
+    auto matH = std::make_unique<float[]>(params.M * params.ldc);
 
-    multiplier.runKernel(gridDim, blockDim);
+    populate_matrix(matA.get(), params.M, params.K, params.lda);
+    populate_matrix(matB.get(), params.K, params.N, params.ldb);
 
-    std::memcpy(matC.get(), bufC.contents(), sizeof(float) * NROWS * NCOLS);
+    device_matrix_multiply("build/matmul_kernel.metallib", matA.get(),
+                           matB.get(), matC.get(), params, GemmEpilogue{});
 
-    print_matrix(matC.get(), NROWS, NCOLS);
+    print_matrix(matC.get(), params.M, params.N, params.ldc);
 
-    host_matrix_multiply(matA.get(), matB.get(), matH.get(), NROWS, NCOLS);
+    host_matrix_multiply(matA.get(), matB.get(), matH.get(), params.M,
+                         params.N, params.K, params.lda, params.ldb,
+                         params.ldc);
 
-    if (compare_matrices(matC.get(), matH.get(), NROWS, NCOLS)) {
+    if (compare_matrices(matC.get(), params.ldc, matH.get(), params.ldc,
+                         params.M, params.N)) {
         std::cout << "Matrix multiplication matches" << std::endl;
     } else {
         std::cout << "Matrix multiplication "
@@ -1,43 +1,133 @@
+#include <Host/HalfPrecision.hpp>
+#include <complex>
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
 #include <utils/util.hpp>
 
-void print_matrix(float *matrix, int nrows, int ncols) {
+static void print_value(float value) { printf("%.2f ", value); }
+
+static void print_value(double value) { printf("%.2f ", value); }
+
+template <class R> static void print_value(std::complex<R> value) {
+    printf("%.2f%+.2fi ", (double)value.real(), (double)value.imag());
+}
+
+// A random 2 digit number, or one per component
+template <class T> static void random_value(T &value) { value = rand() % 100; }
+
+template <class R> static void random_value(std::complex<R> &value) {
+    R re = rand() % 100;
+    R im = rand() % 100;
+    value = std::complex<R>(re, im);
+}
+
+static void random_value(float16 &value) {
+    value = float_to_half(rand() % 100);
+}
+
+static void random_value(bfloat16 &value) {
+    value = float_to_bfloat16(rand() % 100);
+}
+
+template <class T>
+static void fill_random(T *matrix, int nrows, int ncols, int ld) {
     if (!matrix)
         return;
 
+    srand(time(NULL));
     for (int i = 0; i < nrows; ++i) {
         for (int j = 0; j < ncols; ++j) {
-            int idx = i * ncols + j;
-            printf("%.2f ", matrix[idx]);
+            size_t idx = (size_t)i * ld + j;
+            random_value(matrix[idx]);
         }
-        printf("\n");
     }
 }
 
-void populate_matrix(float *matrix, int nrows, int ncols) {
+template <class T> void print_matrix(const T *matrix, int nrows, int ncols) {
+    print_matrix(matrix, nrows, ncols, ncols);
+}
+
+template <class T>
+void print_matrix(const T *matrix, int nrows, int ncols, int ld) {
     if (!matrix)
         return;
 
-    srand(time(NULL));
     for (int i = 0; i < nrows; ++i) {
         for (int j = 0; j < ncols; ++j) {
-            int idx = i * ncols + j;
-            float num = rand() % 100; // Geneate a random 2 digit number
-            matrix[idx] = num;
+            size_t idx = (size_t)i * ld + j;
+            print_value(matrix[idx]);
         }
+        printf("\n");
     }
 }
 
-bool compare_matrices(float *mat1, float *mat2, int nrows, int ncols) {
+template <class T> void populate_matrix(T *matrix, int nrows, int ncols) {
+    populate_matrix(matrix, nrows, ncols, ncols);
+}
+
+template <class T>
+void populate_matrix(T *matrix, int nrows, int ncols, int ld) {
+    fill_random(matrix, nrows, ncols, ld);
+}
+
+void populate_matrix(float16 *matrix, int nrows, int ncols) {
+    fill_random(matrix, nrows, ncols, ncols);
+}
+
+void populate_matrix(float16 *matrix, int nrows, int ncols, int ld) {
+    fill_random(matrix, nrows, ncols, ld);
+}
+
+void populate_matrix(bfloat16 *matrix, int nrows, int ncols) {
+    fill_random(matrix, nrows, ncols, ncols);
+}
+
+void populate_matrix(bfloat16 *matrix, int nrows, int ncols, int ld) {
+    fill_random(matrix, nrows, ncols, ld);
+}
+
+template <class T>
+bool compare_matrices(const T *mat1, const T *mat2, int nrows, int ncols) {
+    return compare_matrices(mat1, ncols, mat2, ncols, nrows, ncols);
+}
+
+template <class T>
+bool compare_matrices(const T *mat1, int ld1, const T *mat2, int ld2,
+                      int nrows, int ncols) {
     if (!mat1 || !mat2)
         return false;
 
     for (int i = 0; i < nrows; ++i) {
         for (int j = 0; j < ncols; ++j) {
-            int idx = i * ncols + j;
-            if (mat1[idx] != mat2[idx]) {
+            if (mat1[(size_t)i * ld1 + j] != mat2[(size_t)i * ld2 + j]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+template <class T>
+bool compare_matrices(const T *mat1, const T *mat2, int nrows, int ncols,
+                      double tolerance) {
+    return compare_matrices(mat1, ncols, mat2, ncols, nrows, ncols,
+                            tolerance);
+}
+
+template <class T>
+bool compare_matrices(const T *mat1, int ld1, const T *mat2, int ld2,
+                      int nrows, int ncols, double tolerance) {
+    if (!mat1 || !mat2)
+        return false;
+
+    for (int i = 0; i < nrows; ++i) {
+        for (int j = 0; j < ncols; ++j) {
+            T value = mat1[(size_t)i * ld1 + j];
+            T reference = mat2[(size_t)i * ld2 + j];
+            double bound = tolerance * fmax(1.0, std::abs(reference));
+            if (!(std::abs(value - reference) <= bound)) {
                 return false;
             }
         }
@@ -56,3 +146,19 @@ void populate_standard_matrix(float *matrix) {
     matrix[7] = 3;
     matrix[8] = 3;
 }
+
+#define UTIL_INSTANTIATE(T)                                                    \
+    template void print_matrix(const T *, int, int);                           \
+    template void print_matrix(const T *, int, int, int);                      \
+    template void populate_matrix(T *, int, int);                              \
+    template void populate_matrix(T *, int, int, int);                         \
+    template bool compare_matrices(const T *, const T *, int, int);            \
+    template bool compare_matrices(const T *, int, const T *, int, int, int);  \
+    template bool compare_matrices(const T *, const T *, int, int, double);    \
+    template bool compare_matrices(const T *, int, const T *, int, int, int,   \
+                                   double);
+
+UTIL_INSTANTIATE(float)
+UTIL_INSTANTIATE(double)
+UTIL_INSTANTIATE(std::complex<float>)
+UTIL_INSTANTIATE(std::complex<double>)
@@ -1,21 +1,94 @@
 #include <metal_stdlib>
+#include <Metal/MetalGemmParams.h>
 using namespace metal;
 
-// vector_add kernel: C = A + B
+// Epilogue of element (row, col), in the same order as the host GemmEpilogue:
+// act(value * scale + bias) + residual
+static float apply_epilogue(
+    float value,
+    uint row,
+    uint col,
+    constant GemmParams& params,
+    device const float* scale,
+    device const float* bias,
+    device const float* residual)
+{
+    if (params.epilogue & GEMM_EPILOGUE_SCALE) {
+        value *= scale[col];
+    }
+    if (params.epilogue & GEMM_EPILOGUE_BIAS) {
+        value += bias[col];
+    }
+
+    if (params.activation == GEMM_ACTIVATION_RELU) {
+        value = max(value, 0.0f);
+    } else if (params.activation == GEMM_ACTIVATION_GELU) {
+        float inner = 0.7978845608f * (value + 0.044715f * value * value * value);
+        value = 0.5f * value * (1.0f + precise::tanh(inner));
+    }
+
+    if (params.epilogue & GEMM_EPILOGUE_RESIDUAL) {
+        value += residual[row * params.ldr + col];
+    }
+    return value;
+}
+
+// C = epilogue(A * B) for an M x K matrix A and a K x N matrix B, one thread
+// per element of C. The grid is N x M and may be rounded up to whole
+// threadgroups, so threads outside C return early. Epilogue inputs that are
+// not flagged in params.epilogue are never read, but a buffer must still be
+// bound at their index.
 kernel void device_matrix_multiply(
     device const float* A [[buffer(0)]],
     device const float* B [[buffer(1)]],
     device float* C [[buffer(2)]],
-    constant uint& width [[buffer(3)]],
+    constant GemmParams& params [[buffer(3)]],
+    device const float* scale [[buffer(4)]],
+    device const float* bias [[buffer(5)]],
+    device const float* residual [[buffer(6)]],
     uint2 id [[thread_position_in_grid]])
 {
     uint row = id.y;
     uint col = id.x;
 
+    if (row >= params.M || col >= params.N) {
+        return;
+    }
+
+    float sum = 0;
+
+    for (uint k = 0; k < params.K; ++k) {
+        sum += A[row * params.lda + k] * B[k * params.ldb + col];
+    }
+    C[row * params.ldc + col] =
+        apply_epilogue(sum, row, col, params, scale, bias, residual);
+}
+
+// Strided batch of C_i = A_i * B_i in a single dispatch. The grid is
+// N x M x batch, one thread per element of every C_i.
+kernel void device_matrix_multiply_batched(
+    device const float* A [[buffer(0)]],
+    device const float* B [[buffer(1)]],
+    device float* C [[buffer(2)]],
+    constant GemmParams& params [[buffer(3)]],
+    uint3 id [[thread_position_in_grid]])
+{
+    uint row = id.y;
+    uint col = id.x;
+    uint member = id.z;
+
+    if (row >= params.M || col >= params.N || member >= params.batch) {
+        return;
+    }
+
+    A += member * params.strideA;
+    B += member * params.strideB;
+    C += member * params.strideC;
+
     float sum = 0;
 
-    for (uint k = 0; k < width; ++k) {
-        sum += A[row * width + k] * B[k * width + col];
+    for (uint k = 0; k < params.K; ++k) {
+        sum += A[row * params.lda + k] * B[k * params.ldb + col];
     }
-    C[row * width + col] = sum;
+    C[row * params.ldc + col] = sum;
 }